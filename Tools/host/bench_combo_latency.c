@@ -0,0 +1,108 @@
+// Average keystroke latency the combo matcher adds over a typing trace, with and without the
+// layer gate (combos_live()). Model of the chord buffer: a key that belongs to a combo the
+// matcher considers is held back until its combo term runs out or the next key goes down,
+// whichever is first. Keys in no considered combo go out at once.
+//
+// The trace types prose on layer 0 and random keys on the layer 1 and layer 2 jumps, with
+// 40-240 ms between presses. The trace is deterministic, run it against another revision with
+// KEYMAP_DIR to compare.
+#include "host.h"
+#include KEYMAP_C
+
+#define PRESSES_PER_SEGMENT 20000
+
+typedef struct {
+    const char* name;
+    uint32_t    presses;
+    uint32_t    buffered[2];    // Ungated, gated
+    uint64_t    added_ms[2];
+} segment_t;
+
+static uint32_t seed = 1;
+
+static uint32_t next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+// Longest term among the combos a key is held back for
+static uint16_t hold_term(combo_set_t combos) {
+    uint16_t term = 0;
+    for (; combos; combos &= combos - 1) {
+        term = MAX(term, combo_term_get(__builtin_ctz(combos)));
+    }
+    return term;
+}
+
+static void press(segment_t* segment, keypos_t key, uint16_t gap) {
+    keyrecord_t record  = {.event = {.key = key}};
+    uint16_t    keycode = get_record_keycode(&record, false);
+    if (keycode == KC_NO) {
+        return;
+    }
+    combo_set_t combos = combos_at[key.row * MATRIX_COLS + key.col];
+    combo_set_t gated  = combos & combos_live();
+
+    segment->presses++;
+    combo_set_t considered[2] = {combos, gated};
+    for (int g = 0; g < 2; g++) {
+        if (considered[g]) {
+            segment->buffered[g]++;
+            segment->added_ms[g] += MIN(hold_term(considered[g]), gap);
+        }
+    }
+}
+
+// Layer 0 key that types a letter or space on tap, mod-taps and dual keys by their tap keycode
+static keypos_t prose_key(char c) {
+    uint8_t tap = (c == ' ') ? KC_SPC : (uint8_t)(KC_A + (c - 'a'));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint16_t keycode = keymaps[0][row][col];
+            if (keycode >= SAFE_RANGE && (size_t)(keycode - SAFE_RANGE) < ARRAY_SIZE(dual_keys)) {
+                keycode = dual_keys[keycode - SAFE_RANGE].tap;
+            } else if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+                keycode &= 0xFF;
+            }
+            if (keycode == tap) {
+                return (keypos_t){.col = col, .row = row};
+            }
+        }
+    }
+    fprintf(stderr, "no key types '%c'\n", c);
+    exit(1);
+}
+
+static void run_prose(segment_t* segment) {
+    static const char prose[] = "the quick brown fox jumps over the lazy dog while we wait for new combos to settle ";
+    layer_state = 0;
+    for (uint32_t i = 0; segment->presses < PRESSES_PER_SEGMENT; i++) {
+        char c = prose[i % (sizeof(prose) - 1)];
+        press(segment, prose_key(c), 40 + next_random() % 200);
+    }
+}
+
+static void run_layer(segment_t* segment, uint8_t layer) {
+    layer_state = (layer_state_t)1 << layer;
+    while (segment->presses < PRESSES_PER_SEGMENT) {
+        uint16_t r = next_random();
+        press(segment, (keypos_t){.col = r % MATRIX_COLS, .row = (r / MATRIX_COLS) % MATRIX_ROWS}, 40 + next_random() % 200);
+    }
+}
+
+int main(void) {
+    host_init();
+    segment_t segments[] = {{"layer 0 prose"}, {"layer 1 jump"}, {"layer 2 jump"}};
+    run_prose(&segments[0]);
+    run_layer(&segments[1], 1);
+    run_layer(&segments[2], 2);
+
+    printf("%-14s %8s  %-26s  %-26s\n", "", "presses", "every combo key buffered", "layer gate");
+    for (size_t i = 0; i < ARRAY_SIZE(segments); i++) {
+        segment_t* s = &segments[i];
+        printf("%-14s %8u  %5.1f%% buffered %5.2f ms/key  %5.1f%% buffered %5.2f ms/key\n", s->name, (unsigned)s->presses,
+               100.0 * s->buffered[0] / s->presses, (double)s->added_ms[0] / s->presses,
+               100.0 * s->buffered[1] / s->presses, (double)s->added_ms[1] / s->presses);
+    }
+    return 0;
+}
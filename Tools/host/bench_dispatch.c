@@ -0,0 +1,58 @@
+// Time per process_record_user() call for the dual-function keys, and for keycodes that are not
+// custom keys at all and only pass through it. Press and release alternate, one key at a time.
+// Releases of dual-function keys tap their key, so most of their time is the stubbed report path,
+// the dispatch itself is the difference between revisions.
+// Run it against the revision before the dual_keys[] table with KEYMAP_DIR to compare with the switch.
+#include "host.h"
+#include KEYMAP_C
+
+#define ROUNDS  5000
+#define REPEATS 5
+
+static const uint16_t dual_keycodes[] = {
+    O_CAPS_L1, O_SPC_L2, I_SPC_L1, I_SPC_L2, R_MB1, R_MB2, L_MB1,  L_MB2,  R_SHIFT,
+    L_SHIFT,   ML_MB1,   ML_MB2,   ESC_GRV,  LTB_BK, RTB_FW, CT_UN, CW_LW, NX_PR,
+    UN_RE,     CO_PA,    VU_VD,    CT_TW,    DE_CU,  CW_FS,  DL_DR, PU_PD, HM_EN,
+};
+
+static const uint16_t plain_keycodes[] = {KC_A, KC_E, KC_SPC, KC_ENT, KC_LSFT, KC_1};
+
+// Best of REPEATS batches of ROUNDS press/release pairs, ns per call averaged over the keycodes
+static double bench_keys(const uint16_t* keycodes, size_t count) {
+    keyrecord_t record = {.event = {.key = {.col = 0, .row = 0}, .type = KEY_EVENT}};
+    double      ns     = 0;
+    for (size_t k = 0; k < count; k++) {
+        double best = 0;
+        for (int repeat = 0; repeat < REPEATS; repeat++) {
+            double start = host_clock_ns();
+            for (int r = 0; r < ROUNDS; r++) {
+                record.event.time    = timer_read();
+                record.event.pressed = true;
+                process_record_user(keycodes[k], &record);
+                record.event.pressed = false;
+                process_record_user(keycodes[k], &record);
+            }
+            double batch = host_clock_ns() - start;
+            best         = (repeat == 0 || batch < best) ? batch : best;
+            host_typed_clear();
+            host_tick(300);
+        }
+        ns += best;
+    }
+    return ns / (2.0 * ROUNDS * count);
+}
+
+int main(void) {
+    host_init();
+    host_tick(1000);
+
+    // Warm up caches and the branch predictor before the timed runs
+    bench_keys(dual_keycodes, ARRAY_SIZE(dual_keycodes));
+
+    printf("process_record_user() ns per call, best of %u batches of %u press/release pairs per key\n", REPEATS, ROUNDS);
+    printf("%-20s %4s  %7s\n", "keys", "n", "ns/call");
+    printf("%-20s %4zu  %7.1f\n", "dual-function", ARRAY_SIZE(dual_keycodes), bench_keys(dual_keycodes, ARRAY_SIZE(dual_keycodes)));
+    printf("%-20s %4zu  %7.1f\n", "plain (not custom)", ARRAY_SIZE(plain_keycodes),
+           bench_keys(plain_keycodes, ARRAY_SIZE(plain_keycodes)));
+    return 0;
+}
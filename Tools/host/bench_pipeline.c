@@ -0,0 +1,186 @@
+// Function calls and by-value report_mouse_t copies per report inside keymap.c's pointing path.
+// Built with -finstrument-functions -fno-inline, so every keymap.c function entry is counted,
+// inline helpers included; time per report is bench_pointing's job, not this one's.
+// Copies come from the signatures in the keymap source: each report_mouse_t taken or returned
+// by value is one copy per call. Run it with KEYMAP_DIR against an older revision to compare.
+#include <ctype.h>
+#include <unistd.h>
+#include "host.h"
+#include KEYMAP_C
+
+#define REPORTS     100000
+#define MAX_FUNCS   256
+
+int main(void);
+
+#define NOINST __attribute__((no_instrument_function))
+
+typedef struct {
+    void*    fn;
+    uint64_t calls;
+} func_count_t;
+
+static func_count_t funcs[MAX_FUNCS];
+static bool         counting = false;
+
+NOINST void __cyg_profile_func_enter(void* fn, void* call_site) {
+    if (!counting) {
+        return;
+    }
+    size_t i = ((uintptr_t)fn >> 4) % MAX_FUNCS;
+    while (funcs[i].fn && funcs[i].fn != fn) {
+        i = (i + 1) % MAX_FUNCS;
+    }
+    funcs[i].fn = fn;
+    funcs[i].calls++;
+}
+
+NOINST void __cyg_profile_func_exit(void* fn, void* call_site) {}
+
+// Function name for an address, from nm on this binary
+NOINST static const char* func_name(void* fn, char* name, size_t size) {
+    static char   names[1024][64];
+    static void*  addrs[1024];
+    static size_t count = 0;
+    static bool   loaded = false;
+    if (!loaded) {
+        char exe[512], command[600];
+        ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+        exe[length > 0 ? length : 0] = '\0';
+        snprintf(command, sizeof(command), "nm '%s'", exe);
+        FILE*     nm = popen(command, "r");
+        char      line[256];
+        loaded = true;
+        uintptr_t main_nm = 0;
+        while (nm && fgets(line, sizeof(line), nm) && count < 1024) {
+            unsigned long addr;
+            char          type, sym[64];
+            if (sscanf(line, "%lx %c %63s", &addr, &type, sym) == 3 && (type == 't' || type == 'T')) {
+                snprintf(names[count], sizeof(names[count]), "%s", sym);
+                addrs[count++] = (void*)addr;
+                if (!strcmp(sym, "main")) {
+                    main_nm = addr;
+                }
+            }
+        }
+        if (nm) {
+            pclose(nm);
+        }
+        uintptr_t base = (uintptr_t)&main - main_nm;    // PIE load offset
+        for (size_t i = 0; i < count; i++) {
+            addrs[i] = (void*)((uintptr_t)addrs[i] + base);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (addrs[i] == fn) {
+            snprintf(name, size, "%s", names[i]);
+            return name;
+        }
+    }
+    snprintf(name, size, "%p", fn);
+    return name;
+}
+
+// report_mouse_t values in a function's definition, parameters and return type, -1 if keymap.c doesn't define it
+NOINST static int report_copies(const char* source, const char* name) {
+    size_t len = strlen(name);
+    for (const char* p = strstr(source, name); p; p = strstr(p + 1, name)) {
+        const char* line = p;
+        while (line > source && line[-1] != '\n') {
+            line--;
+        }
+        if (p[len] != '(' || *line == ' ' || *line == '/' || *line == '*' || *line == '#' || (p > source && (p[-1] == '_' || isalnum((unsigned char)p[-1])))) {
+            continue;
+        }
+        int copies = 0;
+        for (const char* t = line; *t && *t != ')'; t++) {
+            if (!strncmp(t, "report_mouse_t", 14)) {
+                const char* after = t + 14;
+                while (*after == ' ') {
+                    after++;
+                }
+                copies += *after != '*';
+            }
+        }
+        return copies;
+    }
+    return -1;
+}
+
+NOINST static char* read_source(void) {
+    FILE* file = fopen(KEYMAP_C, "rb");
+    HOST_CHECK(file, "can't open %s", KEYMAP_C);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    char* source = malloc(size + 1);
+    source[fread(source, 1, size, file)] = '\0';
+    fclose(file);
+    return source;
+}
+
+NOINST static void run(const char* scenario, const char* source, uint8_t layer, bool moving, bool arrow_ball) {
+    layer_move(layer);
+    report_mouse_t click = {.buttons = 1}, none = {0};
+    if (arrow_ball) {
+        for (int i = 0; i < 2; i++) {       // Double tap the right ball for arrow mode
+            pointing_device_task_combined_user(none, click);
+            host_tick(30);
+            pointing_device_task_combined_user(none, none);
+            host_tick(30);
+        }
+    }
+    host_tick(500);
+    memset(funcs, 0, sizeof(funcs));
+    host_reset_counters();
+
+    counting = true;
+    for (int i = 0; i < REPORTS; i++) {
+        report_mouse_t left = none, right = none;
+        if (moving) {
+            right.x = 3;
+            right.y = -2;
+        }
+        pointing_device_task_combined_user(left, right);
+        host_tick(1);
+    }
+    counting = false;
+
+    double calls = 0, copies = 0;
+    char   name[64], detail[1024] = "";
+    for (size_t i = 0; i < MAX_FUNCS; i++) {
+        if (funcs[i].fn) {
+            double per_report = (double)funcs[i].calls / REPORTS;
+            int    by_value   = report_copies(source, func_name(funcs[i].fn, name, sizeof(name)));
+            if (by_value < 0) {     // Stub or harness function
+                continue;
+            }
+            calls += per_report;
+            copies += per_report * by_value;
+            if (per_report >= 0.5 && strlen(detail) < sizeof(detail) - 80) {
+                snprintf(detail + strlen(detail), sizeof(detail) - strlen(detail), "    %-40s %5.2f%s\n", name, per_report,
+                         by_value ? " (by value)" : "");
+            }
+        }
+    }
+    printf("%-22s %6.2f calls  %5.2f report copies  %4.2f combines per report\n%s", scenario, calls, copies,
+           (double)host_calls.combines / REPORTS, detail);
+    if (arrow_ball) {
+        pointing_device_task_combined_user(none, click);
+        pointing_device_task_combined_user(none, none);
+    }
+    host_tick(1000);
+}
+
+int main(void) {
+    host_init();
+    char* source = read_source();
+    printf("keymap.c functions entered per report (including the scan loop between reports), %d reports each\n", REPORTS);
+    run("idle", source, 0, false, false);
+    run("cursor", source, 0, true, false);
+    run("arrow ball", source, 0, true, true);
+    run("layer 1 arrows", source, 1, true, false);
+    run("layer 1 + arrow ball", source, 1, true, true);
+    free(source);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Pushes report pairs through pointing_device_task_combined_user() for every mode combination
+// and prints the cost per report: time on this host and the QMK calls it causes.
+// One report per simulated ms, the scan loop (deferred executors, housekeeping) runs between them
+// and its calls are counted too, since that is where the pointing path queues its RGB and RPCs.
+//
+//   BENCH_REPORTS=200000 make -C Tools/host bench     fewer reports per row
+#include "host.h"
+#include KEYMAP_C
+
+typedef enum { BALL_OFF, BALL_ARROW, BALL_SCROLL } ball_mode_t;
+
+static const char* const ball_names[]   = {"off", "arrow", "scroll"};
+static const char* const motion_names[] = {"idle", "moving"};
+
+// Clicks the right ball the way a user does: double tap for arrows, tap and wait for scroll
+static void ball_click(void) {
+    report_mouse_t left = {0}, right = {.buttons = 1};
+    pointing_device_task_combined_user(left, right);
+    host_tick(30);
+    right.buttons = 0;
+    pointing_device_task_combined_user(left, right);
+    host_tick(30);
+}
+
+static void ball_set(ball_mode_t mode) {
+    report_mouse_t none = {0};
+    if (mode == BALL_ARROW) {
+        ball_click();
+        ball_click();
+    } else if (mode == BALL_SCROLL) {
+        ball_click();
+        host_tick(400);
+        pointing_device_task_combined_user(none, none);
+    }
+    host_tick(50);
+}
+
+// Measures clock_gettime() around an empty body so it can be taken off each report
+static double clock_overhead_ns(void) {
+    double total = 0;
+    for (int i = 0; i < 100000; i++) {
+        double start = host_clock_ns();
+        total += host_clock_ns() - start;
+    }
+    return total / 100000;
+}
+
+static void bench_row(uint8_t layer, ball_mode_t ball, bool atml, bool moving, long reports, double overhead) {
+    layer_move(layer);
+    if (atml != ATML) {
+        host_tap(ML_AUTO, 20);
+    }
+    ball_set(ball);
+    host_tick(100);
+    host_reset_counters();
+
+    double         ns   = 0;
+    volatile int   sink = 0;
+    report_mouse_t none = {0};
+    for (long i = 0; i < reports; i++) {
+        report_mouse_t left = none, right = none;
+        if (moving) {
+            right.x = 3;
+            right.y = -2;
+            left.x  = (i & 3) ? 0 : 1;
+        }
+        double         start    = host_clock_ns();
+        report_mouse_t combined = pointing_device_task_combined_user(left, right);
+        ns += host_clock_ns() - start - overhead;
+        sink += combined.x;
+        host_tick(1);
+    }
+    (void)sink;
+
+    double n = (double)reports;
+    printf("%5u  %-6s  %-4s  %-6s  %7.1f  %7.2f  %7.2f  %7.1f  %7.1f  %8.3f\n", layer, ball_names[ball], atml ? "on" : "off",
+           motion_names[moving], ns / n, 1000 * host_calls.rpcs / n, 1000 * host_calls.i2c_writes / n,
+           1000 * host_calls.taps / n, 1000 * host_calls.layer_sets / n, host_calls.combines / n);
+
+    // Back to a known state for the next row
+    if (ball != BALL_OFF) {
+        ball_click();
+    }
+    host_tick(1000);
+}
+
+int main(void) {
+    const char* env     = getenv("BENCH_REPORTS");
+    long        reports = env ? atol(env) : 1000000;
+    host_init();
+    double overhead = clock_overhead_ns();
+
+    printf("%ld reports per row, one per ms, clock overhead %.1f ns taken off\n", reports, overhead);
+    printf("ns and combine calls are per report, rpc, i2c, tap and layer sets per 1000 reports\n");
+    printf("layer  ball    atml  motion       ns      rpc      i2c      tap    layer   combine\n");
+    for (uint8_t layer = 0; layer <= 2; layer++) {
+        for (ball_mode_t ball = BALL_OFF; ball <= BALL_SCROLL; ball++) {
+            for (int atml = 0; atml <= 1; atml++) {
+                for (int moving = 0; moving <= 1; moving++) {
+                    bench_row(layer, ball, atml, moving, reports, overhead);
+                }
+            }
+        }
+    }
+    return 0;
+}
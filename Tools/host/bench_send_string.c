@@ -0,0 +1,60 @@
+// Keyboard reports per string: send_batch() as the macro player runs it, with and without NKRO,
+// against QMK's send_string(). Also checks each path types the same text.
+#include "host.h"
+#include KEYMAP_C
+
+static const char* const strings[] = {
+    " 2326",
+    "the quick brown fox jumps over the lazy dog",
+    "Hello, World! (QMK) <3",
+    "if (x->y[i] != NULL) { return -1; }",
+    "\x01" "Ab\x02" " CD",    // Leading and inner characters with no keycode
+};
+
+// Expected output: what the keycode table can type
+static void typeable(const char* text, char* out) {
+    for (; *text; text++) {
+        if (ascii_to_keycode_lut[(uint8_t)*text & 0x7F] != KC_NO) {
+            *out++ = *text;
+        }
+    }
+    *out = '\0';
+}
+
+static void type_batched(const char* text) {
+    while (*text) {
+        text = send_batch(text);
+    }
+}
+
+typedef void (*typer_t)(const char*);
+
+static uint32_t run(typer_t typer, const char* text, const char* expected) {
+    host_typed_clear();
+    host_reset_counters();
+    typer(text);
+    HOST_CHECK(strcmp(host_typed, expected) == 0, "typed \"%s\", expected \"%s\"", host_typed, expected);
+    return host_calls.reports;
+}
+
+int main(void) {
+    host_init();
+    printf("keyboard reports per string\n");
+    printf("%-46s %5s  %11s  %12s  %12s\n", "string", "chars", "send_string", "batched 6KRO", "batched NKRO");
+    for (size_t i = 0; i < ARRAY_SIZE(strings); i++) {
+        char expected[128];
+        typeable(strings[i], expected);
+
+        uint32_t plain     = run(send_string, strings[i], expected);
+        keymap_config.nkro = false;
+        uint32_t six       = run(type_batched, strings[i], expected);
+        keymap_config.nkro = true;
+        uint32_t nkro      = run(type_batched, strings[i], expected);
+        HOST_CHECK(nkro <= plain, "batched sent %u reports, send_string() %u", (unsigned)nkro, (unsigned)plain);
+
+        char label[48];
+        snprintf(label, sizeof(label), "\"%.44s\"", expected);
+        printf("%-46s %5zu  %11u  %12u  %12u\n", label, strlen(expected), (unsigned)plain, (unsigned)six, (unsigned)nkro);
+    }
+    return 0;
+}
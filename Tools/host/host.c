@@ -0,0 +1,563 @@
+// Host implementations of the QMK calls keymap.c makes, see host.h
+#include <time.h>
+#include "host.h"
+#include "hal.h"
+#include "action_tapping.h"
+
+host_calls_t host_calls;
+uint32_t     host_now;
+uint32_t     host_scans;
+bool         host_master = true;
+char         host_typed[1024];
+size_t       host_typed_len;
+
+layer_state_t   layer_state;
+layer_state_t   default_layer_state;
+keymap_config_t keymap_config = {.nkro = true};
+bool            debug_enable;
+SysTick_Type    host_systick;
+
+void host_reset_counters(void) {
+    memset(&host_calls, 0, sizeof(host_calls));
+}
+
+void host_typed_clear(void) {
+    host_typed_len = 0;
+    host_typed[0]  = '\0';
+}
+
+double host_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// ---------------------------------------------------------------- timer.h
+
+uint16_t timer_read(void) {
+    return (uint16_t)host_now;
+}
+
+uint32_t timer_read32(void) {
+    return host_now;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return (uint16_t)(host_now - last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return host_now - last;
+}
+
+// Blocks like the real one: time passes but nothing else runs
+void wait_ms(uint32_t ms) {
+    host_now += ms;
+    host_calls.blocked_ms += ms;
+}
+
+// ---------------------------------------------------------------- deferred_exec.c
+
+// Same contract as QMK: tokens are never reused back to back, a nonzero return reschedules
+// relative to the trigger time, zero frees the slot
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+    void*                  cb_arg;
+} host_executor_t;
+
+static host_executor_t executors[MAX_DEFERRED_EXECUTORS];
+static deferred_token  last_token;
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void* cb_arg) {
+    if (!delay_ms || !callback) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        host_executor_t* entry = &executors[i];
+        if (entry->token == INVALID_DEFERRED_TOKEN) {
+            if (++last_token == INVALID_DEFERRED_TOKEN) {
+                ++last_token;
+            }
+            *entry = (host_executor_t){last_token, host_now + delay_ms, callback, cb_arg};
+            return last_token;
+        }
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+static host_executor_t* executor_find(deferred_token token) {
+    for (int i = 0; token != INVALID_DEFERRED_TOKEN && i < MAX_DEFERRED_EXECUTORS; i++) {
+        if (executors[i].token == token) {
+            return &executors[i];
+        }
+    }
+    return NULL;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    host_executor_t* entry = executor_find(token);
+    if (!entry || !delay_ms) {
+        return false;
+    }
+    entry->trigger_time = host_now + delay_ms;
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    host_executor_t* entry = executor_find(token);
+    if (!entry) {
+        return false;
+    }
+    entry->token = INVALID_DEFERRED_TOKEN;
+    return true;
+}
+
+static void deferred_exec_task(void) {
+    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        host_executor_t* entry = &executors[i];
+        if (entry->token != INVALID_DEFERRED_TOKEN && (int32_t)(host_now - entry->trigger_time) >= 0) {
+            uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
+            if (delay_ms) {
+                entry->trigger_time += delay_ms;
+            } else {
+                entry->token = INVALID_DEFERRED_TOKEN;
+            }
+        }
+    }
+}
+
+void host_tick(uint32_t ms) {
+    while (ms--) {
+        host_now++;
+        host_scans++;
+        deferred_exec_task();
+        housekeeping_task_user();
+    }
+}
+
+// ---------------------------------------------------------------- action_layer.c
+
+layer_state_t layer_state_set(layer_state_t state) {
+    host_calls.layer_sets++;
+    layer_state = layer_state_set_user(state);
+    return layer_state;
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | ((layer_state_t)1 << layer));
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+void layer_move(uint8_t layer) {
+    layer_state_set((layer_state_t)1 << layer);
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    if (!state) {
+        return layer == 0;
+    }
+    return (state & ((layer_state_t)1 << layer)) != 0;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    return state ? 31 - __builtin_clz(state) : 0;
+}
+
+// ---------------------------------------------------------------- keymap / action
+
+bool is_keyboard_master(void) {
+    return host_master;
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    return keymaps[layer][key.row][key.col];
+}
+
+uint8_t host_active_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t layer = 31; layer >= 0; layer--) {
+        if ((layers >> layer) & 1 && layer < DYNAMIC_KEYMAP_LAYER_COUNT && keymap_key_to_keycode(layer, key) != KC_TRNS) {
+            return layer;
+        }
+    }
+    return 0;
+}
+
+uint16_t get_record_keycode(keyrecord_t* record, bool update_layer_cache) {
+    (void)update_layer_cache;
+    return keymap_key_to_keycode(host_active_layer(record->event.key), record->event.key);
+}
+
+keypos_t host_find_key(uint16_t keycode) {
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (keymaps[layer][row][col] == keycode) {
+                    return (keypos_t){.col = col, .row = row};
+                }
+            }
+        }
+    }
+    fprintf(stderr, "keycode 0x%04X is not in the keymap\n", keycode);
+    exit(1);
+}
+
+// No tapping engine: records go on to process_record_user() as they come, custom keycodes see them
+// like process_record_user() would. The keymap's chord matcher replays held back keys through here.
+void action_tapping_process(keyrecord_t record) {
+    uint16_t keycode = record.keycode;
+    if (process_record_user(keycode, &record) && keycode <= 0xFF) {
+        // Basic keycodes the keymap leaves to QMK, so held modifiers show up in get_mods()
+        record.event.pressed ? register_code((uint8_t)keycode) : unregister_code((uint8_t)keycode);
+    }
+}
+
+void host_event(keypos_t key, uint16_t keycode, bool pressed) {
+    keyrecord_t record = {
+        .event   = {.key = key, .time = timer_read(), .type = KEY_EVENT, .pressed = pressed},
+        .keycode = keycode,
+    };
+    if (pre_process_record_user(keycode, &record)) {
+        action_tapping_process(record);
+    }
+}
+
+void host_key(keypos_t key, bool pressed) {
+    keyrecord_t record = {.event = {.key = key}};
+    host_event(key, get_record_keycode(&record, true), pressed);
+}
+
+void host_keycode(uint16_t keycode, bool pressed) {
+    host_event(host_find_key(keycode), keycode, pressed);
+}
+
+void host_tap(uint16_t keycode, uint16_t hold_ms) {
+    host_keycode(keycode, true);
+    host_tick(hold_ms);
+    host_keycode(keycode, false);
+}
+
+// ---------------------------------------------------------------- keyboard report
+
+static uint8_t mods, weak_mods;
+static uint8_t keys[32], sent_keys[32];
+
+// Reverse of ascii_to_keycode_lut, first entry wins like a host keyboard layout would
+static char keycode_to_ascii(uint8_t keycode, bool shifted) {
+    for (uint8_t c = 1; c < 128; c++) {
+        bool c_shifted = (ascii_to_shift_lut[c >> 3] >> (c & 7)) & 1;
+        if (ascii_to_keycode_lut[c] == keycode && c_shifted == shifted) {
+            return (char)c;
+        }
+    }
+    return 0;
+}
+
+// Decodes keys newly pressed in this report in usage order, the way a host reads an NKRO bitmap
+void send_keyboard_report(void) {
+    host_calls.reports++;
+    bool shifted = (mods | weak_mods) & MOD_MASK_SHIFT;
+    for (int kc = 0; kc < 256; kc++) {
+        bool down = (keys[kc >> 3] >> (kc & 7)) & 1;
+        bool was  = (sent_keys[kc >> 3] >> (kc & 7)) & 1;
+        char c    = down && !was ? keycode_to_ascii((uint8_t)kc, shifted) : 0;
+        if (c && host_typed_len < sizeof(host_typed) - 1) {
+            host_typed[host_typed_len++] = c;
+            host_typed[host_typed_len]   = '\0';
+        }
+    }
+    memcpy(sent_keys, keys, sizeof(keys));
+}
+
+void add_key(uint8_t key) {
+    keys[key >> 3] |= 1 << (key & 7);
+}
+
+void del_key(uint8_t key) {
+    keys[key >> 3] &= ~(1 << (key & 7));
+}
+
+uint8_t get_mods(void) {
+    return mods;
+}
+
+void add_mods(uint8_t m) {
+    mods |= m;
+}
+
+void del_mods(uint8_t m) {
+    mods &= ~m;
+}
+
+void register_mods(uint8_t m) {
+    mods |= m;
+    send_keyboard_report();
+}
+
+void unregister_mods(uint8_t m) {
+    mods &= ~m;
+    send_keyboard_report();
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void add_weak_mods(uint8_t m) {
+    weak_mods |= m;
+}
+
+void del_weak_mods(uint8_t m) {
+    weak_mods &= ~m;
+}
+
+void clear_keyboard(void) {
+    mods = weak_mods = 0;
+    memset(keys, 0, sizeof(keys));
+    send_keyboard_report();
+}
+
+void register_code(uint8_t code) {
+    if (code >= KC_LCTL && code <= KC_RGUI) {
+        register_mods(MOD_BIT(code));
+        return;
+    }
+    add_key(code);
+    send_keyboard_report();
+}
+
+void unregister_code(uint8_t code) {
+    if (code >= KC_LCTL && code <= KC_RGUI) {
+        unregister_mods(MOD_BIT(code));
+        return;
+    }
+    del_key(code);
+    send_keyboard_report();
+}
+
+// Left and right mods from the 5-bit field of a 16-bit keycode
+static uint8_t keycode_mods(uint16_t code) {
+    uint8_t m = (code >> 8) & 0x0F;
+    return (code & 0x1000) ? (uint8_t)(m << 4) : m;
+}
+
+void register_code16(uint16_t code) {
+    if (keycode_mods(code)) {
+        register_mods(keycode_mods(code));
+    }
+    register_code((uint8_t)code);
+}
+
+void unregister_code16(uint16_t code) {
+    unregister_code((uint8_t)code);
+    if (keycode_mods(code)) {
+        unregister_mods(keycode_mods(code));
+    }
+}
+
+void tap_code(uint8_t code) {
+    host_calls.taps++;
+    register_code(code);
+    unregister_code(code);
+}
+
+void tap_code16(uint16_t code) {
+    host_calls.taps++;
+    register_code16(code);
+    unregister_code16(code);
+}
+
+// ---------------------------------------------------------------- send_string.c
+
+#define KCLUT_ENTRY(a, b, c, d, e, f, g, h) \
+    ((a) << 0 | (b) << 1 | (c) << 2 | (d) << 3 | (e) << 4 | (f) << 5 | (g) << 6 | (h) << 7)
+
+const uint8_t ascii_to_shift_lut[16] = {
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),
+    KCLUT_ENTRY(0, 1, 1, 1, 1, 1, 1, 0),    //   ! " # $ % & '
+    KCLUT_ENTRY(1, 1, 1, 1, 0, 0, 0, 0),    // ( ) * + , - . /
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),    // 0 1 2 3 4 5 6 7
+    KCLUT_ENTRY(0, 0, 1, 0, 1, 0, 1, 1),    // 8 9 : ; < = > ?
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),    // @ A B C D E F G
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),    // H I J K L M N O
+    KCLUT_ENTRY(1, 1, 1, 1, 1, 1, 1, 1),    // P Q R S T U V W
+    KCLUT_ENTRY(1, 1, 1, 0, 0, 0, 1, 1),    // X Y Z [ \ ] ^ _
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),    // ` a b c d e f g
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),    // h i j k l m n o
+    KCLUT_ENTRY(0, 0, 0, 0, 0, 0, 0, 0),    // p q r s t u v w
+    KCLUT_ENTRY(0, 0, 0, 1, 1, 1, 1, 0),    // x y z { | } ~ DEL
+};
+
+const uint8_t ascii_to_keycode_lut[128] = {
+    // NUL   SOH      STX      ETX      EOT      ENQ      ACK      BEL
+    KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,
+    // BS    TAB      LF       VT       FF       CR       SO       SI
+    KC_BSPC, KC_TAB,  KC_ENT,  KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,
+    // DLE   DC1      DC2      DC3      DC4      NAK      SYN      ETB
+    KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,
+    // CAN   EM       SUB      ESC      FS       GS       RS       US
+    KC_NO,   KC_NO,   KC_NO,   KC_ESC,  KC_NO,   KC_NO,   KC_NO,   KC_NO,
+    //       !        "        #        $        %        &        '
+    KC_SPC,  KC_1,    KC_QUOT, KC_3,    KC_4,    KC_5,    KC_7,    KC_QUOT,
+    // (     )        *        +        ,        -        .        /
+    KC_9,    KC_0,    KC_8,    KC_EQL,  KC_COMM, KC_MINS, KC_DOT,  KC_SLSH,
+    // 0     1        2        3        4        5        6        7
+    KC_0,    KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6,    KC_7,
+    // 8     9        :        ;        <        =        >        ?
+    KC_8,    KC_9,    KC_SCLN, KC_SCLN, KC_COMM, KC_EQL,  KC_DOT,  KC_SLSH,
+    // @     A        B        C        D        E        F        G
+    KC_2,    KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,
+    // H     I        J        K        L        M        N        O
+    KC_H,    KC_I,    KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,
+    // P     Q        R        S        T        U        V        W
+    KC_P,    KC_Q,    KC_R,    KC_S,    KC_T,    KC_U,    KC_V,    KC_W,
+    // X     Y        Z        [        \        ]        ^        _
+    KC_X,    KC_Y,    KC_Z,    KC_LBRC, KC_BSLS, KC_RBRC, KC_6,    KC_MINS,
+    // `     a        b        c        d        e        f        g
+    KC_GRV,  KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,
+    // h     i        j        k        l        m        n        o
+    KC_H,    KC_I,    KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,
+    // p     q        r        s        t        u        v        w
+    KC_P,    KC_Q,    KC_R,    KC_S,    KC_T,    KC_U,    KC_V,    KC_W,
+    // x     y        z        {        |        }        ~        DEL
+    KC_X,    KC_Y,    KC_Z,    KC_LBRC, KC_BSLS, KC_RBRC, KC_GRV,  KC_DEL,
+};
+
+// Same path as QMK with TAP_CODE_DELAY 0: shift around a tap, two to four reports per character
+void send_char(char ascii_code) {
+    uint8_t c       = (uint8_t)ascii_code & 0x7F;
+    uint8_t keycode = ascii_to_keycode_lut[c];
+    bool    shifted = (ascii_to_shift_lut[c >> 3] >> (c & 7)) & 1;
+    if (keycode == KC_NO) {
+        return;
+    }
+    if (shifted) {
+        register_code(KC_LSFT);
+    }
+    tap_code(keycode);
+    if (shifted) {
+        unregister_code(KC_LSFT);
+    }
+}
+
+void send_string(const char* string) {
+    while (*string) {
+        send_char(*string++);
+    }
+}
+
+// ---------------------------------------------------------------- led / caps word
+
+led_t host_keyboard_led_state(void) {
+    return (led_t){0};
+}
+
+bool is_caps_word_on(void) {
+    return false;
+}
+
+// ---------------------------------------------------------------- split, pointing
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {
+    (void)transaction_id;
+    (void)callback;
+}
+
+bool transaction_rpc_send(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void* initiator2target_buffer) {
+    (void)transaction_id;
+    (void)initiator2target_buffer_size;
+    (void)initiator2target_buffer;
+    host_calls.rpcs++;
+    return true;
+}
+
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void* initiator2target_buffer,
+                          uint8_t target2initiator_buffer_size, void* target2initiator_buffer) {
+    (void)target2initiator_buffer_size;
+    (void)target2initiator_buffer;
+    return transaction_rpc_send(transaction_id, initiator2target_buffer_size, initiator2target_buffer);
+}
+
+void pimoroni_trackball_set_rgbw(uint8_t red, uint8_t green, uint8_t blue, uint8_t white) {
+    (void)red;
+    (void)green;
+    (void)blue;
+    (void)white;
+    host_calls.i2c_writes++;
+}
+
+// Same as QMK's default: sums the two reports
+report_mouse_t pointing_device_combine_reports(report_mouse_t left_report, report_mouse_t right_report) {
+    host_calls.combines++;
+    left_report.x += right_report.x;
+    left_report.y += right_report.y;
+    left_report.h += right_report.h;
+    left_report.v += right_report.v;
+    left_report.buttons |= right_report.buttons;
+    return left_report;
+}
+
+// ---------------------------------------------------------------- eeconfig
+
+static uint8_t user_datablock[EECONFIG_USER_DATA_SIZE + 1];
+static bool    user_datablock_valid;
+
+bool eeconfig_is_user_datablock_valid(void) {
+    return user_datablock_valid;
+}
+
+uint32_t eeconfig_read_user_datablock(void* data, uint32_t offset, uint32_t length) {
+    memcpy(data, user_datablock + offset, length);
+    return length;
+}
+
+uint32_t eeconfig_update_user_datablock(const void* data, uint32_t offset, uint32_t length) {
+    host_calls.ee_writes++;
+    memcpy(user_datablock + offset, data, length);
+    user_datablock_valid = true;
+    return length;
+}
+
+// ---------------------------------------------------------------- weak user hooks, as in QMK
+
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) void housekeeping_task_user(void) {}
+
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t* record) {
+    return true;
+}
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+    return true;
+}
+
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+    return state;
+}
+
+// ---------------------------------------------------------------- setup
+
+void host_init(void) {
+    memset(executors, 0, sizeof(executors));
+    layer_state         = 0;
+    default_layer_state = 1;
+    mods = weak_mods = 0;
+    memset(keys, 0, sizeof(keys));
+    memset(sent_keys, 0, sizeof(sent_keys));
+    host_now = 1000;
+    keyboard_post_init_user();
+    host_reset_counters();
+    host_typed_clear();
+}
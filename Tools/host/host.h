@@ -0,0 +1,60 @@
+// Host harness for keymap.c: simulated clock, deferred executors, key events, call counters.
+// keymap.c is compiled unchanged against stubs/, see the "Host Build" section of README.md
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include QMK_KEYBOARD_H
+#include "transactions.h"
+
+// Calls into QMK that cost time or bandwidth on the board, reset with host_reset_counters()
+typedef struct {
+    uint32_t taps;          // tap_code() / tap_code16()
+    uint32_t reports;       // Keyboard reports sent to the host
+    uint32_t rpcs;          // Split transactions, each one is a serial round trip
+    uint32_t i2c_writes;    // pimoroni_trackball_set_rgbw(), each one is an I2C write
+    uint32_t combines;      // pointing_device_combine_reports()
+    uint32_t layer_sets;    // layer_state_set()
+    uint32_t ee_writes;     // EEPROM datablock updates
+    uint32_t blocked_ms;    // Time spent inside wait_ms(), the scan loop is stalled for this long
+} host_calls_t;
+
+extern host_calls_t host_calls;
+extern uint32_t     host_now;           // Simulated timer, ms
+extern uint32_t     host_scans;         // Scan loop passes run by host_tick()
+extern bool         host_master;        // is_keyboard_master()
+extern char         host_typed[1024];   // Text decoded from the keyboard reports
+extern size_t       host_typed_len;
+
+void host_init(void);                   // Fresh state and keyboard_post_init_user(), once per process
+void host_reset_counters(void);
+void host_typed_clear(void);
+void host_tick(uint32_t ms);            // Runs the scan loop 1 ms at a time: deferred executors, housekeeping
+void host_key(keypos_t key, bool pressed);          // Key event through pre_process/process_record_user
+void host_keycode(uint16_t keycode, bool pressed);  // Same, for a keycode wherever it sits in the keymap
+void host_event(keypos_t key, uint16_t keycode, bool pressed);  // Same, for a keycode not in the keymap
+void host_tap(uint16_t keycode, uint16_t hold_ms);
+keypos_t host_find_key(uint16_t keycode);           // Matrix position, lowest layer first, aborts if missing
+uint8_t  host_active_layer(keypos_t key);           // Layer QMK reads the key from, KC_TRNS falls through
+
+// Keymap entry points the harness and tests call directly
+void           keyboard_post_init_user(void);
+void           housekeeping_task_user(void);
+bool           pre_process_record_user(uint16_t keycode, keyrecord_t* record);
+bool           process_record_user(uint16_t keycode, keyrecord_t* record);
+layer_state_t  layer_state_set_user(layer_state_t state);
+report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, report_mouse_t right_report);
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+// Test helpers
+#define HOST_CHECK(cond, ...)                                                \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n  ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                    \
+            fputc('\n', stderr);                                             \
+            exit(1);                                                         \
+        }                                                                    \
+    } while (0)
+
+double host_clock_ns(void);             // Wall clock for benchmarks
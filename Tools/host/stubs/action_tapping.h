@@ -0,0 +1,6 @@
+// Host stand-in, host.c has no tapping engine and hands records straight to process_record_user()
+#pragma once
+
+#include "keyboard.h"
+
+void action_tapping_process(keyrecord_t record);
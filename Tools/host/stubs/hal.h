@@ -0,0 +1,17 @@
+// Host stand-in for the ChibiOS SysTick used by STAGE_PROFILE, counts down like the real one
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+extern SysTick_Type host_systick;
+#define SysTick                     (&host_systick)
+#define SysTick_CTRL_ENABLE_Msk     (1u << 0)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1u << 2)
+#define SysTick_LOAD_RELOAD_Msk     0xFFFFFFu
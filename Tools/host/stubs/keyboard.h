@@ -0,0 +1,265 @@
+// Host stand-in for QMK_KEYBOARD_H, just the parts of QMK that keymap.c uses
+// Keycode and mod values match QMK so tables and tapping terms behave like on the board.
+// Behaviour lives in ../host.c, tests reach it through ../host.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "config.h"
+
+// QMK defaults for what config.h leaves out, so older revisions build too
+#ifndef MAX_DEFERRED_EXECUTORS
+#    define MAX_DEFERRED_EXECUTORS 8
+#endif
+#ifndef EECONFIG_USER_DATA_SIZE
+#    define EECONFIG_USER_DATA_SIZE 0
+#endif
+#ifndef DYNAMIC_KEYMAP_LAYER_COUNT
+#    define DYNAMIC_KEYMAP_LAYER_COUNT 4
+#endif
+
+// progmem
+#define PROGMEM
+#define pgm_read_byte(p)    (*(const uint8_t*)(p))
+#define pgm_read_word(p)    (*(const uint16_t*)(p))
+#define pgm_read_dword(p)   (*(const uint32_t*)(p))
+#define memcpy_P(d, s, n)   memcpy(d, s, n)
+
+// util.h
+#define ARRAY_SIZE(a)       (sizeof(a) / sizeof((a)[0]))
+#ifndef MAX
+#    define MAX(a, b)       ((a) > (b) ? (a) : (b))
+#endif
+#ifndef MIN
+#    define MIN(a, b)       ((a) < (b) ? (a) : (b))
+#endif
+
+// lily58/rev1
+#define MATRIX_ROWS 10
+#define MATRIX_COLS 6
+#define LAYOUT(L00, L01, L02, L03, L04, L05, R00, R01, R02, R03, R04, R05, \
+               L10, L11, L12, L13, L14, L15, R10, R11, R12, R13, R14, R15, \
+               L20, L21, L22, L23, L24, L25, R20, R21, R22, R23, R24, R25, \
+               L30, L31, L32, L33, L34, L35, L45, R40, R30, R31, R32, R33, R34, R35, \
+               L41, L42, L43, L44, R41, R42, R43, R44) \
+    { \
+        { L00, L01, L02, L03, L04, L05 }, \
+        { L10, L11, L12, L13, L14, L15 }, \
+        { L20, L21, L22, L23, L24, L25 }, \
+        { L30, L31, L32, L33, L34, L35 }, \
+        { KC_NO, L41, L42, L43, L44, L45 }, \
+        { R05, R04, R03, R02, R01, R00 }, \
+        { R15, R14, R13, R12, R11, R10 }, \
+        { R25, R24, R23, R22, R21, R20 }, \
+        { R35, R34, R33, R32, R31, R30 }, \
+        { KC_NO, R44, R43, R42, R41, R40 } \
+    }
+
+// action_layer.h
+typedef uint32_t layer_state_t;
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+layer_state_t layer_state_set(layer_state_t state);
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+void          layer_move(uint8_t layer);
+bool          layer_state_is(uint8_t layer);
+bool          layer_state_cmp(layer_state_t state, uint8_t layer);
+uint8_t       get_highest_layer(layer_state_t state);
+
+// keyboard.h / action.h
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+enum keyevent_type { TICK_EVENT = 0, KEY_EVENT = 1, ENCODER_CW_EVENT, ENCODER_CCW_EVENT, COMBO_EVENT };
+
+typedef struct {
+    keypos_t key;
+    uint16_t time;
+    uint8_t  type;
+    bool     pressed;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;     // Only with COMBO_ENABLE or REPEAT_KEY_ENABLE in QMK, here host.c passes the keycode in it
+} keyrecord_t;
+
+#define IS_KEYEVENT(event)  ((event).type == KEY_EVENT)
+#define IS_COMBOEVENT(event) ((event).type == COMBO_EVENT)
+#define KEYLOC_COMBO        254     // Row and col of a COMBO_EVENT
+
+bool     is_keyboard_master(void);
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+uint16_t get_record_keycode(keyrecord_t* record, bool update_layer_cache);
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record);
+bool     get_permissive_hold(uint16_t keycode, keyrecord_t* record);
+
+// timer.h
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+void wait_ms(uint32_t ms);
+
+// deferred_exec.h
+typedef uint8_t deferred_token;
+#define INVALID_DEFERRED_TOKEN 0
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void* cb_arg);
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void* cb_arg);
+bool           extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool           cancel_deferred_exec(deferred_token token);
+
+// keycodes.h, QMK values
+enum hid_keycodes {
+    KC_NO = 0x00, KC_TRNS = 0x01,
+    KC_A = 0x04, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+    KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z,
+    KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+    KC_ENT, KC_ESC, KC_BSPC, KC_TAB, KC_SPC, KC_MINS, KC_EQL, KC_LBRC, KC_RBRC, KC_BSLS,
+    KC_NUHS, KC_SCLN, KC_QUOT, KC_GRV, KC_COMM, KC_DOT, KC_SLSH, KC_CAPS,
+    KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_F11, KC_F12,
+    KC_PSCR, KC_SCRL, KC_PAUS, KC_INS, KC_HOME, KC_PGUP, KC_DEL, KC_END, KC_PGDN,
+    KC_RIGHT, KC_LEFT, KC_DOWN, KC_UP,
+    KC_NUM, KC_PSLS, KC_PAST, KC_PMNS, KC_PPLS, KC_PENT,
+    KC_P1, KC_P2, KC_P3, KC_P4, KC_P5, KC_P6, KC_P7, KC_P8, KC_P9, KC_P0, KC_PDOT,
+    KC_NUBS, KC_APP,
+    KC_MUTE = 0xA8, KC_VOLU, KC_VOLD, KC_MNXT, KC_MPRV, KC_MSTP, KC_MPLY,
+    KC_WBAK = 0xBA, KC_WFWD,
+    KC_MS_BTN1 = 0xD1, KC_MS_BTN2, KC_MS_BTN3,
+    KC_LCTL = 0xE0, KC_LSFT, KC_LALT, KC_LGUI, KC_RCTL, KC_RSFT, KC_RALT, KC_RGUI
+};
+#define KC_RGHT         KC_RIGHT
+#define KC_COMMA        KC_COMM
+#define KC_INSERT       KC_INS
+#define KC_WWW_BACK     KC_WBAK
+#define KC_WWW_FORWARD  KC_WFWD
+
+#define QK_LCTL         0x0100
+#define QK_LSFT         0x0200
+#define QK_LALT         0x0400
+#define QK_LGUI         0x0800
+#define QK_MODS_MAX     0x1FFF
+#define C(kc)           (QK_LCTL | (kc))
+#define S(kc)           (QK_LSFT | (kc))
+#define A(kc)           (QK_LALT | (kc))
+#define G(kc)           (QK_LGUI | (kc))
+#define LCA(kc)         (QK_LCTL | QK_LALT | (kc))
+#define LSG(kc)         (QK_LSFT | QK_LGUI | (kc))
+#define RCTL(kc)        (0x1100 | (kc))
+#define RCS(kc)         (0x1300 | (kc))
+#define KC_LPRN         S(KC_9)
+#define KC_RPRN         S(KC_0)
+#define KC_LCBR         S(KC_LBRC)
+#define KC_RCBR         S(KC_RBRC)
+#define KC_ASTR         S(KC_8)
+
+enum mods_5bit { MOD_LCTL = 0x01, MOD_LSFT = 0x02, MOD_LALT = 0x04, MOD_LGUI = 0x08,
+                 MOD_RCTL = 0x11, MOD_RSFT = 0x12, MOD_RALT = 0x14, MOD_RGUI = 0x18 };
+#define MOD_BIT(kc)     (1 << ((kc) & 0x07))
+#define MOD_MASK_SHIFT  (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_CTRL   (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+
+#define QK_MOD_TAP              0x2000
+#define QK_MOD_TAP_MAX          0x3FFF
+#define QK_LAYER_TAP            0x4000
+#define QK_LAYER_TAP_MAX        0x4FFF
+#define MT(mod, kc)             (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LT(layer, kc)           (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+#define IS_QK_MOD_TAP(code)     ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code)   ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc)   ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define DF(layer)               (0x5220 | ((layer) & 0x1F))
+#define QK_CLEAR_EEPROM         0x7C03
+#define EE_CLR                  QK_CLEAR_EEPROM
+#define QK_COMBO_ON             0x7C50
+#define QK_COMBO_OFF            0x7C51
+#define QK_COMBO_TOGGLE         0x7C52
+#define CM_ON                   QK_COMBO_ON
+#define CM_OFF                  QK_COMBO_OFF
+#define CM_TOGG                 QK_COMBO_TOGGLE
+#define QK_USER                 0x7E40
+#define SAFE_RANGE              QK_USER
+
+// action.h / action_util.h
+void    tap_code(uint8_t code);
+void    tap_code16(uint16_t code);
+void    register_code(uint8_t code);
+void    unregister_code(uint8_t code);
+void    register_code16(uint16_t code);
+void    unregister_code16(uint16_t code);
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    register_mods(uint8_t mods);
+void    unregister_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    add_key(uint8_t key);
+void    del_key(uint8_t key);
+void    send_keyboard_report(void);
+void    clear_keyboard(void);
+
+typedef struct {
+    bool nkro;
+} keymap_config_t;
+extern keymap_config_t keymap_config;
+
+// send_string.h
+extern const uint8_t ascii_to_shift_lut[16];
+extern const uint8_t ascii_to_keycode_lut[128];
+void send_string(const char* string);
+void send_char(char ascii_code);
+
+// led.h, caps_word.h
+typedef union {
+    uint8_t raw;
+    struct {
+        bool    num_lock : 1;
+        bool    caps_lock : 1;
+        bool    scroll_lock : 1;
+        bool    compose : 1;
+        bool    kana : 1;
+        uint8_t reserved : 3;
+    };
+} led_t;
+led_t host_keyboard_led_state(void);
+bool  is_caps_word_on(void);
+
+// report.h, pointing_device.h, pimoroni_trackball.h
+typedef int8_t mouse_xy_report_t;
+typedef struct {
+    uint8_t           report_id;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    int8_t            v;
+    int8_t            h;
+} report_mouse_t;
+report_mouse_t pointing_device_combine_reports(report_mouse_t left_report, report_mouse_t right_report);
+void           pimoroni_trackball_set_rgbw(uint8_t red, uint8_t green, uint8_t blue, uint8_t white);
+
+// eeconfig.h
+bool     eeconfig_is_user_datablock_valid(void);
+uint32_t eeconfig_read_user_datablock(void* data, uint32_t offset, uint32_t length);
+uint32_t eeconfig_update_user_datablock(const void* data, uint32_t offset, uint32_t length);
+
+// debug.h
+extern bool debug_enable;
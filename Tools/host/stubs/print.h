@@ -0,0 +1,7 @@
+// Host stand-in, console output goes to stdout
+#pragma once
+
+#include <stdio.h>
+
+#define print(s)        fputs((s), stdout)
+#define uprintf(...)    printf(__VA_ARGS__)
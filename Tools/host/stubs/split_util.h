@@ -0,0 +1,2 @@
+// Host stand-in, nothing from split_util.h is used directly
+#pragma once
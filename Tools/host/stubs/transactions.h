@@ -0,0 +1,15 @@
+// Host stand-in for the split RPC transactions, sends are counted in ../host.c
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum { USER_SYNC = 0 };     // SPLIT_TRANSACTION_IDS_USER
+
+typedef void (*slave_callback_t)(uint8_t initiator2target_buffer_size, const void* initiator2target_buffer,
+                                 uint8_t target2initiator_buffer_size, void* target2initiator_buffer);
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback);
+bool transaction_rpc_send(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void* initiator2target_buffer);
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void* initiator2target_buffer,
+                          uint8_t target2initiator_buffer_size, void* target2initiator_buffer);
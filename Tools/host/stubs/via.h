@@ -0,0 +1,17 @@
+// Host stand-in for the VIA command ids keymap.c looks at
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum via_command_id {
+    id_dynamic_keymap_set_keycode = 0x05,
+    id_dynamic_keymap_reset       = 0x06,
+    id_custom_set_value           = 0x07,
+    id_custom_get_value           = 0x08,
+    id_custom_save                = 0x09,
+    id_dynamic_keymap_set_buffer  = 0x13,
+    id_unhandled                  = 0xFF,
+};
+
+bool via_command_kb(uint8_t* data, uint8_t length);
@@ -0,0 +1,122 @@
+// Learned tapping terms follow taps that get slower, but not lone holds used for the trackball.
+// The host has no QMK tap-hold engine, so the presses go straight to adapt_key_down()/adapt_release()
+// with tap.count set the way QMK would for the current term.
+#include "host.h"
+#include KEYMAP_C
+
+static uint16_t now = 1000;
+
+static keyrecord_t event(bool pressed, uint8_t tap_count) {
+    keyrecord_t record = {.event = {.pressed = pressed, .time = now}};
+    record.tap.count   = tap_count;
+    return record;
+}
+
+typedef enum { OTHER_KEY, CLICK, MOTION } other_t;
+
+// Press held for held ms, another key, a trackball click or motion after other ms (0 = none),
+// resolved by the current term
+static void press_with(uint16_t keycode, uint16_t held, uint16_t other, other_t kind) {
+    keyrecord_t down = event(true, 0);
+    adapt_key_down(keycode, &down);
+    bool tap = !other && held < get_tapping_term(keycode, &down);
+    if (other) {
+        now += other;
+        keyrecord_t    key  = event(true, 0);
+        report_mouse_t none = {0}, ball = {.buttons = (kind == CLICK), .x = (kind == MOTION)};
+        host_now = now;     // adapt_pointer() reads timer_read()
+        if (kind == OTHER_KEY) {
+            adapt_key_down(KC_A, &key);
+        } else {
+            adapt_pointer(&none, &ball);
+        }
+        tap = tap && kind == MOTION;
+        now -= other;
+    }
+    now += held;
+    keyrecord_t up = event(false, tap);
+    adapt_release(keycode, &up);
+    now += 300;
+}
+
+static void press(uint16_t keycode, uint16_t held, uint16_t other) {
+    press_with(keycode, held, other, OTHER_KEY);
+}
+
+static uint32_t dummy_callback(uint32_t trigger_time, void* cb_arg) {
+    return 0;
+}
+
+int main(void) {
+    host_init();
+    const uint16_t alt_del = MT(MOD_LALT, KC_DEL);
+    keyrecord_t    record  = {0};
+
+    // Taps at 100-120ms, holds wanted at 140ms, the term settles between them
+    for (int i = 0; i < 64; i++) {
+        press(alt_del, 100 + i % 21, 0);
+        if (i % 4 == 0) {
+            press(alt_del, 400, 140);
+        }
+    }
+    uint16_t learned = get_tapping_term(alt_del, &record);
+    HOST_CHECK(learned > 120 && learned <= 140, "term %u after taps at 100-120ms and holds at 140ms", learned);
+
+    // Taps slow down to 180ms, past the learned term they come out as holds with nothing else pressed
+    for (int i = 0; i < 200; i++) {
+        press(alt_del, 180, 0);
+    }
+    uint16_t slower = get_tapping_term(alt_del, &record);
+    HOST_CHECK(slower > 180, "term %u after taps slowed to 180ms, was %u", slower, learned);
+
+    // Permissive hold keys: rolls into a shortcut key don't pull the term under taps at 150ms
+    for (int i = 0; i < 64; i++) {
+        press(MT_F, 150, 0);
+        if (i % 4 == 0) {
+            press(MT_F, 300, 40);
+        }
+    }
+    uint16_t permissive = get_tapping_term(MT_F, &record);
+    HOST_CHECK(permissive > 150, "MT_F term %u under its taps at 150ms", permissive);
+
+    // LT(2, KC_TAB) held alone for a trackball click or while the ball moves, not slow taps
+    const uint16_t tab = LT(2, KC_TAB);
+    for (int i = 0; i < 64; i++) {
+        press(tab, 100 + i % 21, 0);
+        if (i % 4 == 0) {
+            press(tab, 400, 140);
+        }
+    }
+    uint16_t tab_learned = get_tapping_term(tab, &record);
+    for (int i = 0; i < 200; i++) {
+        press_with(tab, 160, 60, CLICK);
+    }
+    uint16_t clicked = get_tapping_term(tab, &record);
+    HOST_CHECK(clicked <= tab_learned, "term %u after holds for clicks, was %u", clicked, tab_learned);
+    for (int i = 0; i < 200; i++) {
+        press_with(tab, 160, 60, MOTION);
+    }
+    uint16_t moved = get_tapping_term(tab, &record);
+    HOST_CHECK(moved == clicked, "term %u after holds while the ball moved, was %u", moved, clicked);
+
+    // No free executor for the EEPROM save, the next sample schedules it
+    deadline_cancel(&adapt_token);
+    deferred_token busy[MAX_DEFERRED_EXECUTORS];
+    int            filled = 0;
+    while (filled < MAX_DEFERRED_EXECUTORS && (busy[filled] = defer_exec(60000, dummy_callback, NULL)) != INVALID_DEFERRED_TOKEN) {
+        filled++;
+    }
+    press(tab, 110, 0);
+    HOST_CHECK(adapt_token == INVALID_DEFERRED_TOKEN && adapt_dirty, "save scheduled with every executor taken");
+    while (filled) {
+        cancel_deferred_exec(busy[--filled]);
+    }
+    press(tab, 110, 0);
+    HOST_CHECK(adapt_token != INVALID_DEFERRED_TOKEN, "save not scheduled again once an executor was free");
+
+    printf("Alt/Del term %u ms after taps at 100-120ms, %u ms after they slowed to 180ms, MT_F %u ms with taps at 150ms\n",
+           learned, slower, permissive);
+    printf("LT(2, Tab) term %u ms, %u ms after holds for trackball clicks, %u ms after holds while it moved\n", tab_learned,
+           clicked, moved);
+    return 0;
+}
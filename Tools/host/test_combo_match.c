@@ -0,0 +1,144 @@
+// Combo matcher in keymap.c: the compile-time tables agree with COMBO_LIST, every combo key is a real key
+// on each layer the combo is on, and chords, rolls, releases, CM_TOGG and layers behave like QMK's combos.
+#include "host.h"
+#include KEYMAP_C
+
+#define COMBO_LAYERS(name, output, layers, keys, arg) [name] = (layers),
+static const layer_state_t layers_of[COMBO_COUNT] = {COMBO_LIST(COMBO_LAYERS, 0)};
+
+static void check_tables(void) {
+    for (uint8_t pos = 0; pos < MATRIX_ROWS * MATRIX_COLS; pos++) {
+        combo_set_t want = 0;
+        for (uint8_t i = 0; i < COMBO_COUNT; i++) {
+            want |= (combo_set_t)((combo_keys_read(i) >> pos) & 1) << i;
+        }
+        HOST_CHECK(combos_at[pos] == want, "combos_at[%u] 0x%08X, COMBO_LIST says 0x%08X", pos, (unsigned)combos_at[pos], (unsigned)want);
+    }
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+        combo_set_t want = 0;
+        for (uint8_t i = 0; i < COMBO_COUNT; i++) {
+            want |= (combo_set_t)((layers_of[i] >> layer) & 1) << i;
+        }
+        HOST_CHECK(combos_on[layer] == want, "combos_on[%u] 0x%08X, COMBO_LIST says 0x%08X", layer, (unsigned)combos_on[layer], (unsigned)want);
+    }
+    // A position typo would put a combo on a key that does nothing on its layer
+    for (uint8_t i = 0; i < COMBO_COUNT; i++) {
+        HOST_CHECK(__builtin_popcountll(combo_keys_read(i)) >= 2, "combo %u has fewer than 2 keys", i);
+        for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+            for (key_set_t keys = (layers_of[i] >> layer) & 1 ? combo_keys_read(i) : 0; keys; keys &= keys - 1) {
+                uint8_t  pos     = __builtin_ctzll(keys);
+                uint16_t keycode = keymaps[layer][pos / MATRIX_COLS][pos % MATRIX_COLS];
+                HOST_CHECK(keycode != KC_NO && keycode != KC_TRNS, "combo %u key %u is empty on layer %u", i, pos, layer);
+            }
+        }
+    }
+}
+
+static keypos_t at(uint8_t pos) {
+    return (keypos_t){.col = pos % MATRIX_COLS, .row = pos / MATRIX_COLS};
+}
+
+static void expect_typed(const char* want, const char* what) {
+    HOST_CHECK(strcmp(host_typed, want) == 0, "%s: typed \"%s\", expected \"%s\"", what, host_typed, want);
+    host_typed_clear();
+}
+
+static void check_stack(const char* name, layer_state_t layers, layer_state_t default_layers, int want) {
+    layer_state         = layers;
+    default_layer_state = default_layers;
+    combo_set_t live    = combos_live();
+    printf("%-28s %2d of %d combos live\n", name, __builtin_popcount(live), COMBO_COUNT);
+    HOST_CHECK(__builtin_popcount(live) == want, "%s: %d combos live, expected %d", name, __builtin_popcount(live), want);
+}
+
+int main(void) {
+    host_init();
+    check_tables();
+
+    check_stack("base", 0, 1, 19);
+    check_stack("layer 1 jump", 1 << 1, 1, 0);
+    check_stack("layer 2 jump", 1 << 2, 1, 1);
+    check_stack("layer 4 over 2", 1 << 2 | 1 << 4, 1, 0);
+    check_stack("DF(3) default", 0, 1 << 3, 3);
+    check_stack("auto mouse layer over 1", 1 << 1 | 1 << 3, 1, 3);
+    check_stack("base again", 0, 1, 19);
+    host_typed_clear();
+
+    // A chord fires at once, the first release lets go of the output and the other one is dropped
+    host_key(at(L13), true);
+    host_tick(4);
+    host_key(at(L12), true);
+    HOST_CHECK(combo_held == (combo_set_t)1 << CL_PRN, "E + W didn't fire CL_PRN");
+    host_key(at(L13), false);
+    HOST_CHECK(!combo_held, "CL_PRN still held after E was released");
+    host_tick(20);
+    host_key(at(L12), false);
+    host_tick(100);
+    expect_typed("(", "E + W 4ms apart");
+
+    // A roll slower than the term comes out as the keys, in order
+    host_key(at(L13), true);
+    host_tick(COMBO_TERM + 5);
+    HOST_CHECK(!combo_buffered, "E still held back after COMBO_TERM");
+    host_key(at(L12), true);
+    host_tick(30);
+    host_key(at(L13), false);
+    host_key(at(L12), false);
+    host_tick(100);
+    expect_typed("ew", "E, W 17ms apart");
+
+    // A key that isn't in the chord's combos ends it at once, a key in no combo is never held back
+    host_key(at(L13), true);
+    host_tick(2);
+    host_key(at(L21), true);
+    HOST_CHECK(!combo_buffered && strcmp(host_typed, "ea") == 0, "E, A: typed \"%s\", %u held back", host_typed,
+               combo_buffered);
+    host_key(at(L13), false);
+    host_key(at(L21), false);
+    host_tick(100);
+    expect_typed("ea", "E, A");
+
+    // Released before the chord is complete
+    host_key(at(L13), true);
+    host_tick(2);
+    host_key(at(L13), false);
+    host_tick(2);
+    host_key(at(L12), true);
+    host_tick(30);
+    host_key(at(L12), false);
+    host_tick(100);
+    expect_typed("ew", "E tapped, then W");
+
+    // Custom keycode outputs go through process_record_user()
+    bool swap = BTN_SWAP;
+    host_key(at(L00), true);
+    host_key(at(L01), true);
+    host_key(at(L00), false);
+    host_key(at(L01), false);
+    host_tick(LAYER_RELEASE_DELAY + 10);
+    HOST_CHECK(BTN_SWAP != swap, "Esc + 1 didn't toggle B_SWAP");
+    host_typed_clear();
+
+    // CM_TOGG turns matching off and back on
+    uint16_t toggle[] = {CM_TOGG, CM_TOGG};
+    for (int i = 0; i < 2; i++) {
+        host_event(at(L02), toggle[i], true);
+        host_event(at(L02), toggle[i], false);
+        host_key(at(L13), true);
+        host_key(at(L12), true);
+        host_tick(30);
+        host_key(at(L13), false);
+        host_key(at(L12), false);
+        host_tick(100);
+        expect_typed(i == 0 ? "ew" : "(", i == 0 ? "E + W with combos off" : "E + W with combos back on");
+    }
+
+    // On a layer without combos the keys aren't held back
+    layer_move(1);
+    host_key(at(L13), true);
+    HOST_CHECK(!combo_buffered, "layer 1 key held back");
+    host_key(at(L13), false);
+    layer_move(0);
+    printf("chords, rolls, early releases, custom outputs, CM_TOGG and layers behave like QMK's combos\n");
+    return 0;
+}
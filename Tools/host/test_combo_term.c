@@ -0,0 +1,47 @@
+// Per-combo terms learned from chord skew: crisp chords shrink their term, sloppy ones keep COMBO_TERM,
+// and the same keys typed as a roll, outside COMBO_TERM or just outside the learned term, are not counted.
+#include "host.h"
+#include KEYMAP_C
+
+static void chord(uint16_t a, uint16_t b, uint16_t skew) {
+    host_keycode(a, true);
+    host_tick(skew);
+    host_keycode(b, true);
+    host_tick(30);
+    host_keycode(a, false);
+    host_keycode(b, false);
+    host_tick(300);
+}
+
+int main(void) {
+    host_init();
+    HOST_CHECK(combo_term_get(CL_PRN) == COMBO_TERM, "term before any chords");
+
+    for (int i = 0; i < 40; i++) {
+        chord(i & 1 ? KC_W : KC_E, i & 1 ? KC_E : KC_W, i % 4);   // Either order, 0-3ms apart
+        chord(KC_I, KC_O, 3 + i % 9);                           // 3-11ms apart
+    }
+    uint16_t crisp = combo_term_get(CL_PRN);
+    uint16_t loose = combo_term_get(CR_PRN);
+    printf("E+W chords 0-3ms apart: term %u ms, I+O chords 3-11ms apart: term %u ms (COMBO_TERM %u)\n", crisp, loose,
+           COMBO_TERM);
+    HOST_CHECK(crisp >= COMBO_TERM_MIN && crisp <= 3 + COMBO_SKEW_BUCKET_MS + COMBO_SKEW_MARGIN, "crisp term %u", crisp);
+    HOST_CHECK(loose == COMBO_TERM, "loose term %u", loose);
+
+    // Typing "ew" as a roll, 40ms apart
+    for (int i = 0; i < 40; i++) {
+        chord(KC_E, KC_W, 40);
+    }
+    uint16_t after = combo_term_get(CL_PRN);
+    printf("after 40 rolls 40ms apart: E+W term %u ms\n", after);
+    HOST_CHECK(after == crisp, "rolls changed the term to %u", after);
+
+    // Rolls inside COMBO_TERM but past the learned term come out as normal keys, the combo never fires
+    for (int i = 0; i < 40; i++) {
+        chord(KC_E, KC_W, crisp + 4);
+    }
+    after = combo_term_get(CL_PRN);
+    printf("after 40 rolls %ums apart: E+W term %u ms\n", crisp + 4, after);
+    HOST_CHECK(after == crisp, "rolls that didn't fire changed the term to %u", after);
+    return 0;
+}
@@ -0,0 +1,43 @@
+// FX_SLV_M/FX_SLV_P on the settings layer adjust the left ball with Left Shift held, the right ball
+// with Right Shift held, and both with neither.
+#include "host.h"
+#include KEYMAP_C
+
+static void fx(uint16_t keycode, uint16_t shift) {
+    keypos_t shift_key = {0}, fx_key = host_find_key(keycode);
+    if (shift) {
+        shift_key = host_find_key(shift);
+        host_key(shift_key, true);
+    }
+    host_key(fx_key, true);
+    host_key(fx_key, false);
+    if (shift) {
+        host_key(shift_key, false);
+    }
+    host_tick(10);
+}
+
+int main(void) {
+    host_init();
+    layer_move(4);
+    HOST_CHECK(host_active_layer(host_find_key(KC_RSFT)) == 4, "Right Shift is not on the settings layer");
+
+    uint8_t left = left_accel.growth, right = right_accel.growth;
+    fx(FX_SLV_P, KC_LSFT);
+    HOST_CHECK(left_accel.growth == left + 1 && right_accel.growth == right, "Left Shift: growth %u/%u, was %u/%u",
+               left_accel.growth, right_accel.growth, left, right);
+
+    fx(FX_SLV_M, KC_RSFT);
+    fx(FX_SLV_M, KC_RSFT);
+    HOST_CHECK(left_accel.growth == left + 1 && right_accel.growth == right - 2, "Right Shift: growth %u/%u, was %u/%u",
+               left_accel.growth, right_accel.growth, left, right);
+
+    fx(FX_SLV_P, 0);
+    HOST_CHECK(left_accel.growth == left + 2 && right_accel.growth == right - 1, "no shift: growth %u/%u, was %u/%u",
+               left_accel.growth, right_accel.growth, left, right);
+    HOST_CHECK(get_mods() == 0, "mods 0x%02x left held", get_mods());
+
+    printf("growth left %u -> %u, right %u -> %u, each side adjusted on its own\n", left, left_accel.growth, right,
+           right_accel.growth);
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Layer jump keys free their press record on release whichever way B_SWAP points by then.
+// The jump key used to look its record up only when the BTN_SWAP branch still matched, so swapping
+// while holding it leaked the slot: layer_jump_held() stayed true and the pool slowly filled up.
+#include "host.h"
+#include KEYMAP_C
+
+static void swap_while_held(keypos_t jump, keypos_t swap, uint16_t hold_ms) {
+    host_key(jump, true);
+    host_tick(hold_ms);
+    host_event(swap, B_SWAP, true);
+    host_event(swap, B_SWAP, false);
+    host_tick(10);
+    host_key(jump, false);
+    host_tick(LAYER_RELEASE_DELAY + 10);
+}
+
+int main(void) {
+    host_init();
+    keypos_t jump = host_find_key(O_CAPS_L1);
+    keypos_t swap = {.col = 0, .row = 0};
+
+    for (int round = 0; round < 2 * PRESS_POOL_SIZE; round++) {
+        bool     swapped = BTN_SWAP;
+        uint16_t hold    = (round & 1) ? LAYER_CHANGE_DELAY + 50 : LAYER_CHANGE_DELAY / 2;
+        swap_while_held(jump, swap, hold);
+        HOST_CHECK(press_used == 0, "round %d (BTN_SWAP %d, held %u ms): press slots 0x%02x still in use", round, swapped,
+                   (unsigned)hold, press_used);
+        HOST_CHECK(!layer_jump_held(), "round %d: layer_jump_held() after release", round);
+        HOST_CHECK(!layer_state_is(1), "round %d: layer 1 still on", round);
+    }
+
+    // A jump cancelled by B_SWAP doesn't come back on at its deadline or tap on release
+    if (!BTN_SWAP) {
+        host_event(swap, B_SWAP, true);
+        host_event(swap, B_SWAP, false);
+    }
+    host_typed_clear();
+    host_key(jump, true);
+    host_tick(LAYER_CHANGE_DELAY / 2);
+    host_event(swap, B_SWAP, true);
+    host_event(swap, B_SWAP, false);
+    host_tick(LAYER_CHANGE_DELAY);
+    HOST_CHECK(!layer_state_is(1), "cancelled jump committed at its deadline");
+    host_key(jump, false);
+    host_tick(LAYER_RELEASE_DELAY + 10);
+    HOST_CHECK(host_typed_len == 0, "cancelled jump typed \"%s\"", host_typed);
+
+    printf("%d swaps while holding a jump key, press slots all free\n", 2 * PRESS_POOL_SIZE + 1);
+    return 0;
+}
@@ -0,0 +1,32 @@
+// SE_PW plays from the deferred executor: process_record_user() returns at once, wait_ms() is never
+// called, and the scan loop keeps running (trackball reports still go through) during the 200ms delay.
+#include "host.h"
+#include KEYMAP_C
+
+int main(void) {
+    host_init();
+    keypos_t key = {.col = 0, .row = 0};
+
+    uint32_t start = host_now;
+    host_event(key, SE_PW, true);
+    host_event(key, SE_PW, false);
+    HOST_CHECK(host_now == start, "process_record_user() took %u ms", (unsigned)(host_now - start));
+
+    // Through the delay, one report per ms with the right ball moving
+    uint32_t scans = host_scans, moved = 0;
+    while (macro_pc && host_now - start < 1000) {
+        report_mouse_t left = {0}, right = {.x = 2};
+        moved += pointing_device_task_combined_user(left, right).x != 0;
+        host_tick(1);
+    }
+    uint32_t elapsed = host_now - start;
+
+    printf("macro took %u ms, %u scans and %u moving reports during it, typed \"%s\" in %u reports\n",
+           (unsigned)elapsed, (unsigned)(host_scans - scans), (unsigned)moved, host_typed, (unsigned)host_calls.reports);
+    HOST_CHECK(!macro_pc, "macro still playing after %u ms", (unsigned)elapsed);
+    HOST_CHECK(strcmp(host_typed, " 2326") == 0, "typed \"%s\"", host_typed);
+    HOST_CHECK(host_calls.blocked_ms == 0, "wait_ms() blocked for %u ms", (unsigned)host_calls.blocked_ms);
+    HOST_CHECK(elapsed >= 200 && elapsed < 220, "took %u ms", (unsigned)elapsed);
+    HOST_CHECK(moved >= 200, "only %u of the reports moved the cursor", (unsigned)moved);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// The same hand motion gives the same cursor travel and arrow taps at 125, 500 and 1000Hz.
+// The ball moves along x at 0.1, 0.4, 0 and 0.25 counts per ms for 500ms each, split into whole counts
+// per report. Slow enough that no report leaves int8 at 125Hz.
+// Tolerance: cursor travel within 5% and arrow taps within 1 of the 125Hz run, the reference rate.
+#include "host.h"
+#include KEYMAP_C
+
+#define SEGMENT_MS          500
+#define CURSOR_TOLERANCE    5   // %
+#define ARROW_TOLERANCE     1   // taps
+
+static const double speeds[] = {0.1, 0.4, 0, 0.25};     // Counts per ms
+
+// Travel in output counts, or arrow taps sent when arrow is set
+static long run(uint8_t interval, bool arrow) {
+    right_button.mode = arrow ? MODE_ARROW : MODE_OFF;
+    right_accel.factor = right_accel.min_scale;
+    average_arrow_x = average_arrow_y = 0;
+    host_tick(1000);
+    host_reset_counters();
+
+    long   travel = 0;
+    double moved  = 0;
+    int    sent   = 0;
+    for (size_t s = 0; s < ARRAY_SIZE(speeds); s++) {
+        for (int t = 0; t < SEGMENT_MS; t += interval) {
+            moved += speeds[s] * interval;
+            report_mouse_t left = {0}, right = {.x = (mouse_xy_report_t)((int)moved - sent)};
+            sent += right.x;
+            host_tick(interval);
+            travel += pointing_device_task_combined_user(left, right).x;
+        }
+    }
+    host_tick(1000);    // Lets the arrow queue drain
+    right_button.mode = MODE_OFF;
+    return arrow ? (long)host_calls.taps : travel;
+}
+
+int main(void) {
+    host_init();
+    static const uint8_t intervals[] = {8, 2, 1};   // 125, 500 and 1000Hz
+    long cursor[3], arrows[3];
+    for (int i = 0; i < 3; i++) {
+        cursor[i] = run(intervals[i], false);
+        arrows[i] = run(intervals[i], true);
+        printf("%4dHz: cursor %ld counts, %ld arrow taps\n", 1000 / intervals[i], cursor[i], arrows[i]);
+    }
+    HOST_CHECK(cursor[0] > 0 && arrows[0] > 0, "no motion at 125Hz");
+    for (int i = 1; i < 3; i++) {
+        HOST_CHECK(labs(cursor[i] - cursor[0]) * 100 <= cursor[0] * CURSOR_TOLERANCE, "%dHz cursor %ld vs %ld at 125Hz",
+                   1000 / intervals[i], cursor[i], cursor[0]);
+        HOST_CHECK(labs(arrows[i] - arrows[0]) <= ARROW_TOLERANCE, "%dHz %ld arrow taps vs %ld at 125Hz",
+                   1000 / intervals[i], arrows[i], arrows[0]);
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Idle reports take the early exit in pointing_pipeline() again once arrow mode is left,
+// even if arrow momentum was still building when it ended.
+#include "host.h"
+#include KEYMAP_C
+
+int main(void) {
+    host_init();
+    report_mouse_t none = {0}, slow = {.x = 1};
+
+    // A little motion in arrow mode, not enough for a tap, leaves momentum behind
+    right_button.mode = MODE_ARROW;
+    for (int i = 0; i < 3; i++) {
+        host_tick(8);
+        pointing_device_task_combined_user(none, slow);
+    }
+    HOST_CHECK(average_arrow_x != 0, "no arrow momentum to leave behind");
+
+    right_button.mode = MODE_OFF;
+    host_tick(8);
+    pointing_device_task_combined_user(none, none);
+    HOST_CHECK(!average_arrow_x && !average_arrow_y, "momentum %d/%d kept after arrow mode ended", (int)average_arrow_x,
+               (int)average_arrow_y);
+
+    // Once the scaling average has settled, idle reports go no further than the early exit
+    host_tick(1000);
+    pointing_device_task_combined_user(none, none);
+    host_reset_counters();
+    for (int i = 0; i < 100; i++) {
+        host_tick(8);
+        pointing_device_task_combined_user(none, none);
+    }
+    HOST_CHECK(left_accel.factor == left_accel.min_scale && right_accel.factor == right_accel.min_scale,
+               "scaling average still at %d/%d", (int)left_accel.factor, (int)right_accel.factor);
+    HOST_CHECK(host_calls.taps == 0, "%u arrow taps from idle reports", (unsigned)host_calls.taps);
+    printf("arrow momentum cleared on leaving arrow mode, idle reports take the early exit\n");
+    return 0;
+}
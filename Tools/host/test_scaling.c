@@ -0,0 +1,70 @@
+// Fixed point adaptive scaling against the original integer math it replaced (x1000 gains,
+// integer EMA 94/6 per report). Reports come every 8ms, the rate the old per-report EMA was
+// tuned at and the reference rate of the time-normalized one, so both should agree there.
+// Tolerance: each output axis within 1 count, total travel within 1%.
+#include "host.h"
+#include KEYMAP_C
+
+#define REPORTS 20000
+
+// The pre-Q8 scaling, one average per ball
+typedef struct {
+    int32_t accumulated;
+} old_accel_t;
+
+static void old_scaling(report_mouse_t* mouse_report, old_accel_t* accel) {
+    int32_t abs_x        = (mouse_report->x < 0) ? -mouse_report->x : mouse_report->x;
+    int32_t abs_y        = (mouse_report->y < 0) ? -mouse_report->y : mouse_report->y;
+    int32_t mouse_length = abs_x + abs_y;
+    int32_t factor       = GROWTH_FACTOR * mouse_length * 1000 + 1;
+    accel->accumulated   = (accel->accumulated * 94 + factor * 6) / 100;
+    if (accel->accumulated > 64000) {
+        accel->accumulated = 64000;
+    }
+    mouse_report->x = (int16_t)((mouse_report->x * accel->accumulated) / 1000);
+    mouse_report->y = (int16_t)((mouse_report->y * accel->accumulated) / 1000);
+}
+
+// Bursts of motion at varying speed with pauses, one ball at a time so each output comes from one average
+static int8_t delta(uint32_t* seed, int8_t max) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (int8_t)((int32_t)((*seed >> 16) % (2 * max + 1)) - max);
+}
+
+int main(void) {
+    host_init();
+
+    old_accel_t old_left = {1}, old_right = {1};
+    uint32_t    seed     = 1;
+    long        new_travel = 0, old_travel = 0;
+    for (int i = 0; i < REPORTS; i++) {
+        int            phase = (i / 64) % 4;
+        int8_t         speed = (int8_t)(1 + (i / 256) % 2);  // Up to 32x gain, output stays in int8
+        report_mouse_t left = {0}, right = {0};
+        if (phase < 2) {
+            right.x = delta(&seed, speed);
+            right.y = delta(&seed, speed);
+        } else if (phase == 2) {
+            left.x = delta(&seed, speed);
+            left.y = delta(&seed, speed);
+        }
+
+        report_mouse_t old_l = left, old_r = right;
+        old_scaling(&old_l, &old_left);
+        old_scaling(&old_r, &old_right);
+        int old_x = old_l.x + old_r.x, old_y = old_l.y + old_r.y;
+
+        host_tick(8);
+        report_mouse_t out = pointing_device_task_combined_user(left, right);
+
+        HOST_CHECK(abs(out.x - old_x) <= 1 && abs(out.y - old_y) <= 1, "report %d: new (%d, %d) old (%d, %d)", i, out.x,
+                   out.y, old_x, old_y);
+        new_travel += abs(out.x) + abs(out.y);
+        old_travel += abs(old_x) + abs(old_y);
+    }
+
+    double drift = 100.0 * (new_travel - old_travel) / old_travel;
+    printf("%d reports at 125Hz, travel new %ld old %ld (%+.2f%%)\n", REPORTS, new_travel, old_travel, drift);
+    HOST_CHECK(drift > -1.0 && drift < 1.0, "travel differs by %.2f%%", drift);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# Replays recorded typing through two home row mod policies and compares them.
+#
+#   plain:        tap or hold decided by the tapping term alone, other keys wait for the decision
+#   speculative:  Ctrl/Shift applied on press (SPECULATIVE_HOLD), hold also decided when another
+#                 key is pressed and released inside the mod-tap (PERMISSIVE_HOLD_PER_KEY)
+#
+# The corpus is an event trace from keymap.c (see Tools/trace_decode.py), recorded while typing normally:
+#   qmk console > typing.txt
+#   python3 Tools/hrm_sim.py typing.txt [more.txt ...]
+#
+# Key times come from each record's event time, so the buffering done by the firmware that
+# recorded the trace doesn't skew the replay.
+#
+# Each mod-tap uses its default term from tapping_term_default() in keymap.c. The board may have
+# learned other terms (TAPPING_TERM_ADAPT), pass them as --term MT_F=190 to replay with those.
+
+import bisect
+import os
+import re
+import sys
+
+from trace_decode import records
+
+TRACE_KEY_DOWN = 1
+TRACE_KEY_UP = 2
+
+# Keycodes as in keymap.c, MT(mod, kc) = 0x2000 | mod << 8 | kc
+HOME_ROW_MODS = {
+    0x2109: "MT_F",  # LCtl
+    0x220A: "MT_G",  # LSft
+    0x320B: "MT_H",  # RSft
+    0x310D: "MT_J",  # RCtl
+}
+
+KEYMAP_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def firmware_terms():
+    """Default term per home row mod, read from tapping_term_default() in keymap.c."""
+    with open(os.path.join(KEYMAP_DIR, "config.h")) as config:
+        tapping_term = int(re.search(r"#define\s+TAPPING_TERM\s+(\d+)", config.read()).group(1))
+    with open(os.path.join(KEYMAP_DIR, "keymap.c")) as keymap:
+        source = keymap.read()
+    body = re.search(r"tapping_term_default\(uint16_t keycode\) \{(.*?)\n\}", source, re.S).group(1)
+    terms, labels = {}, []
+    for line in body.splitlines():
+        line = line.strip()
+        if line.startswith("case "):
+            labels.append(line[5:].rstrip(":").strip())
+        elif line.startswith("return "):
+            value = line[7:].rstrip(";")
+            for label in labels:
+                terms[label] = tapping_term if value == "TAPPING_TERM" else int(value)
+            labels = []
+        elif line.startswith("default:"):
+            terms["default"] = tapping_term
+    return {code: terms.get(name, terms.get("default", tapping_term)) for code, name in HOME_ROW_MODS.items()}
+
+
+def key_events(lines):
+    """Physical key events as (time, down, position, keycode), ordered by matrix time."""
+    events = []
+    for now, kind, arg, data in records(lines):
+        if kind not in (TRACE_KEY_DOWN, TRACE_KEY_UP):
+            continue
+        keycode = data[0] | data[1] << 8
+        event_time = data[2] | data[3] << 8
+        # event.time is 16 bit and never later than the record, rebuild it from the record time
+        time = now - ((now - event_time) & 0xFFFF)
+        events.append((time, kind == TRACE_KEY_DOWN, arg, keycode))
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+def presses(events):
+    """Pairs downs with ups per matrix position: (down, up, position, keycode)."""
+    held = {}
+    out = []
+    for time, down, position, keycode in events:
+        if down:
+            held[position] = (time, keycode)
+        elif position in held:
+            start, code = held.pop(position)
+            out.append((start, time, position, code))
+    return sorted(out)
+
+
+def simulate(keys, terms):
+    stats = {"taps": 0, "holds": 0, "tap_to_hold": 0, "hold_to_tap": 0, "agreed_holds": 0, "permissive_holds": 0,
+             "decided_sooner": 0, "decision_saved": 0, "mod_lead": 0, "key_saved": 0, "delayed_keys": 0, "retracted": 0}
+    downs = [k[0] for k in keys]  # keys is sorted by press time
+    for down, up, position, keycode in keys:
+        if keycode not in HOME_ROW_MODS:
+            continue
+        term = terms[keycode]
+        start, end = bisect.bisect_right(downs, down), bisect.bisect_left(downs, up)
+        others = [k for k in keys[start:end] if k[2] != position]
+
+        plain_hold = up - down >= term
+        plain_decided = down + term if plain_hold else up
+
+        nested = [k[1] for k in others if k[1] < up and k[1] < down + term]
+        spec_hold = plain_hold or bool(nested)
+        spec_decided = min([down + term] + nested) if spec_hold else up
+
+        if spec_hold:
+            stats["holds"] += 1
+            stats["mod_lead"] += spec_decided - down  # Speculative mod is down from the press to the decision
+            if plain_hold:
+                stats["agreed_holds"] += 1
+                # Decided by a nested key release before the term, 0 when the term decides both
+                stats["decision_saved"] += plain_decided - spec_decided
+                stats["decided_sooner"] += spec_decided < plain_decided
+            else:
+                stats["permissive_holds"] += 1
+        else:
+            stats["taps"] += 1
+            stats["retracted"] += 1  # Speculative mod went down and was taken back
+        stats["tap_to_hold"] += spec_hold and not plain_hold
+        stats["hold_to_tap"] += plain_hold and not spec_hold
+
+        # Keys pressed while the mod-tap is undecided are held back until the decision
+        for other in others:
+            plain_wait = max(0, plain_decided - other[0])
+            spec_wait = max(0, spec_decided - other[0])
+            if plain_wait:
+                stats["delayed_keys"] += 1
+                stats["key_saved"] += plain_wait - spec_wait
+    return stats
+
+
+def main():
+    terms = firmware_terms()
+    paths = []
+    args = iter(sys.argv[1:])
+    for arg in args:
+        if arg == "--term":
+            name, _, value = next(args, "").partition("=")
+            codes = [code for code, key in HOME_ROW_MODS.items() if key == name]
+            if not codes or not value.isdigit():
+                sys.exit("--term takes NAME=ms with NAME one of " + ", ".join(HOME_ROW_MODS.values()))
+            terms[codes[0]] = int(value)
+        else:
+            paths.append(arg)
+    if not paths:
+        sys.exit("usage: hrm_sim.py [--term MT_F=ms ...] trace.txt [more.txt ...]")
+    keys = []
+    for path in paths:
+        with open(path) as source:
+            keys += presses(key_events(source))
+
+    s = simulate(sorted(keys), terms)
+    total = s["taps"] + s["holds"]
+    if not total:
+        sys.exit("No home row mod presses in the corpus")
+
+    print("Terms:                      %s" % ", ".join("%s %d ms" % (HOME_ROW_MODS[c], terms[c]) for c in HOME_ROW_MODS))
+    print("Home row mod presses:       %d (%d holds, %d taps)" % (total, s["holds"], s["taps"]))
+    print("Tap -> hold vs plain:       %d (%.2f%%), likely roll misfires" % (s["tap_to_hold"], 100.0 * s["tap_to_hold"] / total))
+    print("Hold -> tap vs plain:       %d" % s["hold_to_tap"])
+    print("Speculative mods retracted: %d" % s["retracted"])
+    print("Holds decided permissively: %d that plain would have tapped" % s["permissive_holds"])
+    if s["holds"]:
+        print("Mod down before decision:   %.1f ms avg per hold (speculative)" % (s["mod_lead"] / float(s["holds"])))
+    if s["agreed_holds"]:
+        print("Holds decided sooner:       %d of %d, %.1f ms avg over all of them" % (
+            s["decided_sooner"], s["agreed_holds"], s["decision_saved"] / float(s["agreed_holds"])))
+    if s["delayed_keys"]:
+        print("Keys held back by a mod-tap: %d, released %.1f ms sooner on avg" % (
+            s["delayed_keys"], s["key_saved"] / float(s["delayed_keys"])))
+
+
+if __name__ == "__main__":
+    main()
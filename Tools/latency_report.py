@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# Reads the keypress latency histograms from keymap.c over VIA and prints percentiles.
+#
+# Needs LATENCY_STATS uncommented in config.h (off by default) and the hidapi module (pip install hidapi).
+#   python3 Tools/latency_report.py            print percentiles per category
+#   python3 Tools/latency_report.py --reset    clear the histograms on the board
+#
+# Latency is from the matrix event to the end of its processing, so it includes hold decisions.
+# Buckets are log spaced (4 per power of 2), percentiles report the upper edge of their bucket.
+
+import sys
+
+import hid
+
+VIA_USAGE_PAGE = 0xFF60
+VIA_USAGE = 0x61
+REPORT_SIZE = 32
+
+# Matches keymap.c
+LATENCY_CHANNEL = 0x4C
+ID_CUSTOM_SET_VALUE = 0x07
+ID_CUSTOM_GET_VALUE = 0x08
+ID_UNHANDLED = 0xFF
+LAT_VALUE_INFO = 0
+LAT_VALUE_HIST = 1
+LAT_VALUE_RESET = 2
+CATEGORIES = ["Home row mods", "Layer jump", "Tap-hold", "Other"]
+
+PERCENTILES = [50, 90, 99]
+
+
+def open_board():
+    for info in hid.enumerate():
+        if info["usage_page"] == VIA_USAGE_PAGE and info["usage"] == VIA_USAGE:
+            device = hid.device()
+            device.open_path(info["path"])
+            return device
+    sys.exit("No VIA device found")
+
+
+def command(device, *payload):
+    report = bytes(payload).ljust(REPORT_SIZE, b"\0")
+    device.write(b"\0" + report)  # Report id 0
+    reply = bytes(device.read(REPORT_SIZE, 1000))
+    if len(reply) < REPORT_SIZE or reply[0] == ID_UNHANDLED:
+        sys.exit("Board did not answer, is LATENCY_STATS enabled?")
+    return reply
+
+
+def bucket_range(bucket, sub_bits, last):
+    # Inverse of latency_bucket() in keymap.c, returns [low, high) in ms
+    sub = 1 << sub_bits
+    if bucket < sub:
+        return bucket, bucket + 1
+    if bucket == last:
+        return 1024, None
+    msb = (bucket >> sub_bits) + sub_bits - 1
+    width = 1 << (msb - sub_bits)
+    low = (sub + (bucket & (sub - 1))) * width
+    return low, low + width
+
+
+def read_histogram(device, index, buckets):
+    counts = []
+    while len(counts) < buckets:
+        reply = command(device, ID_CUSTOM_GET_VALUE, LATENCY_CHANNEL, LAT_VALUE_HIST, index, len(counts))
+        for i in range(5, REPORT_SIZE - 1, 2):
+            counts.append(reply[i] | reply[i + 1] << 8)
+    return counts[:buckets]
+
+
+def percentile(counts, ranges, p):
+    total = sum(counts)
+    target = total * p / 100.0
+    seen = 0
+    for count, (low, high) in zip(counts, ranges):
+        seen += count
+        if count and seen >= target:
+            return ">=%d" % low if high is None else "%d" % (high - 1)
+    return "-"
+
+
+def main():
+    device = open_board()
+    if "--reset" in sys.argv:
+        command(device, ID_CUSTOM_SET_VALUE, LATENCY_CHANNEL, LAT_VALUE_RESET)
+        print("Histograms cleared")
+        return
+
+    info = command(device, ID_CUSTOM_GET_VALUE, LATENCY_CHANNEL, LAT_VALUE_INFO)
+    categories, buckets, sub_bits = info[3], info[4], info[5]
+    ranges = [bucket_range(b, sub_bits, buckets - 1) for b in range(buckets)]
+
+    print("%-16s %-8s %7s  %s" % ("Category", "Event", "Count", "  ".join("p%-5d" % p for p in PERCENTILES) + "  max (ms)"))
+    for category in range(categories):
+        name = CATEGORIES[category] if category < len(CATEGORIES) else "Category %d" % category
+        for released, event in enumerate(["press", "release"]):
+            counts = read_histogram(device, category * 2 + released, buckets)
+            total = sum(counts)
+            if not total:
+                continue
+            row = [percentile(counts, ranges, p) for p in PERCENTILES + [100]]
+            print("%-16s %-8s %7d  %s" % (name, event, total, "  ".join("%-6s" % v for v in row)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Reads the per-stage cycle counters from keymap.c over VIA.
+#
+# Needs STAGE_PROFILE in config.h and the hidapi module (pip install hidapi).
+#   python3 Tools/stage_report.py              print min/avg/max per stage
+#   python3 Tools/stage_report.py --reset      clear the counters on the board
+#   python3 Tools/stage_report.py --mhz 133    core clock used for the us columns (default 125)
+
+import struct
+import sys
+
+from latency_report import ID_CUSTOM_GET_VALUE, ID_CUSTOM_SET_VALUE, command, open_board
+
+# Matches keymap.c
+STAGE_CHANNEL = 0x50
+STAGE_VALUE_INFO = 0
+STAGE_VALUE_STAT = 1
+STAGE_VALUE_RESET = 2
+STAGES = [
+    "pointing task",
+    "  buttons",
+    "  mouse mode",
+    "  emulation",
+    "  scaling",
+    "  combine",
+    "layer state",
+    "RPC sync",
+    "LED write",
+]
+
+
+def main():
+    mhz = 125.0
+    if "--mhz" in sys.argv:
+        mhz = float(sys.argv[sys.argv.index("--mhz") + 1])
+
+    device = open_board()
+    if "--reset" in sys.argv:
+        command(device, ID_CUSTOM_SET_VALUE, STAGE_CHANNEL, STAGE_VALUE_RESET)
+        print("Counters cleared")
+        return
+
+    info = command(device, ID_CUSTOM_GET_VALUE, STAGE_CHANNEL, STAGE_VALUE_INFO)
+    stages, reports_per_sec, slowest = info[3], info[4] | info[5] << 8, info[6]
+    print("Mouse reports/s: %d" % reports_per_sec)
+    print("%-16s %10s %10s %10s %10s %10s" % ("Stage", "Calls", "Min cyc", "Avg cyc", "Max cyc", "Max us"))
+    for stage in range(stages):
+        reply = command(device, ID_CUSTOM_GET_VALUE, STAGE_CHANNEL, STAGE_VALUE_STAT, stage)
+        calls, low, avg, high = struct.unpack("<IIII", reply[4:20])
+        name = STAGES[stage] if stage < len(STAGES) else "stage %d" % stage
+        print("%-16s %10d %10d %10d %10d %10.1f%s" % (
+            name, calls, low, avg, high, high / mhz, "  <- slowest" if stage == slowest and calls else ""))
+
+
+if __name__ == "__main__":
+    main()
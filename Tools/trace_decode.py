@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# Decodes the binary event trace printed by keymap.c into a readable timeline.
+#
+# Build with CONSOLE_ENABLE = yes (NO_PRINT commented out), toggle debug on the board, then:
+#   qmk console > trace.txt          (or hid_listen)
+#   python3 Tools/trace_decode.py trace.txt
+# Reads stdin when no file is given. Lines without a "TR:" record are ignored.
+
+import re
+import struct
+import sys
+
+RECORD = re.compile(r"TR:([0-9A-F]{16})")
+
+MODES = {0: "off", 1: "arrow", 2: "scroll", 3: "pending"}
+
+
+def key(arg, data):
+    keycode, event_time = struct.unpack("<HH", data)
+    return "r%d c%d kc=0x%04X event=%d" % (arg >> 4, arg & 0x0F, keycode, event_time)
+
+
+def layer(arg, data):
+    (state,) = struct.unpack("<I", data)
+    return "top=%d state=0x%08X" % (arg, state)
+
+
+def mode(arg, data):
+    return "left=%s right=%s" % (MODES.get(arg & 0x0F, arg & 0x0F), MODES.get(arg >> 4, arg >> 4))
+
+
+def rpc(arg, data):
+    btn_swap, atml, modes, sent = data
+    return "rgb_layer=%d btn_swap=%d atml=%d %s %s" % (
+        arg, btn_swap, atml, mode(modes, b""), "sent" if sent else "FAILED")
+
+
+def mouse(arg, data):
+    x, y, h, v = struct.unpack("<bbbb", data)
+    return "x=%d y=%d h=%d v=%d buttons=0x%02X" % (x, y, h, v, arg)
+
+
+def dropped(arg, data):
+    return "%d%s records lost, ring was full" % (arg, "+" if arg == 255 else "")
+
+
+# Matches trace_type_t in keymap.c
+TYPES = {
+    1: ("KEY_DOWN", key),
+    2: ("KEY_UP", key),
+    3: ("LAYER", layer),
+    4: ("MODE", mode),
+    5: ("RPC", rpc),
+    6: ("MOUSE_L", mouse),
+    7: ("MOUSE_R", mouse),
+    8: ("DROPPED", dropped),
+}
+
+
+def records(lines):
+    """Yields (time_ms, type, arg, data) per record, time unwrapped past the 16 bit timer."""
+    last = None
+    wraps = 0
+    for line in lines:
+        match = RECORD.search(line)
+        if not match:
+            continue
+        raw = bytes.fromhex(match.group(1))
+        time, kind, arg = struct.unpack("<HBB", raw[:4])
+
+        # timer_read() is 16 bit, unwrap assuming records are in order and less than 65s apart
+        if last is not None and time < last:
+            wraps += 1
+        last = time
+        yield time + wraps * 0x10000, kind, arg, raw[4:]
+
+
+def decode(lines):
+    start = None
+    for now, kind, arg, data in records(lines):
+        if start is None:
+            start = now
+            previous = now
+
+        name, fmt = TYPES.get(kind, ("TYPE_%d" % kind, lambda a, d: "arg=%d data=%s" % (a, d.hex())))
+        yield "%9.3f  +%-5d %-9s %s" % ((now - start) / 1000.0, now - previous, name, fmt(arg, data))
+        previous = now
+
+
+def main():
+    source = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    with source:
+        for entry in decode(source):
+            print(entry)
+
+
+if __name__ == "__main__":
+    main()
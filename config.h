@@ -38,10 +38,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TERM_PER_KEY
 #define TAPPING_FORCE_HOLD
 // #define PERMISSIVE_HOLD // Interferes with custom modded tapping terms
+#define PERMISSIVE_HOLD_PER_KEY    // Home row mods only, get_permissive_hold() in keymap.c
+#define SPECULATIVE_HOLD           // Home row Ctrl/Shift applied on press, get_speculative_hold() in keymap.c
+#define TAPPING_TERM_ADAPT         // Per-key terms learned from tap/hold timing in keymap.c, saved to EEPROM
+#define EECONFIG_USER_DATA_SIZE 256 // 8 adapted keys * 32 bytes of histograms, resets VIA keymaps once when changed
 //#define BOTH_SHIFTS_TURNS_ON_CAPS_WORD
 //#define DOUBLE_TAP_SHIFT_TURNS_ON_CAPS_WORD
 
 #define PIMORONI_TRACKBALL_SCALE 2
+// #define LEFT_GROWTH_FACTOR 4        // Per ball acceleration in keymap.c, also LEFT_/RIGHT_MIN_SCALE and _MAX_SCALE (Q8)
+// #define LEFT_MAX_SCALE (16 << 8)    // Unset ones use GROWTH_FACTOR, MIN_SCALE and MAX_SCALE
 // #define MOUSE_EXTENDED_REPORT
 // #define POINTING_DEVICE_DEBUG
 // #define POINTING_DEVICE_TASK_THROTTLE_MS 1
@@ -55,11 +61,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Allow more than 4 layers
 #define DYNAMIC_KEYMAP_LAYER_COUNT 5
 
+// Deadlines in keymap.c run on defer_exec(), default of 8 slots is too tight
+#define MAX_DEFERRED_EXECUTORS 24  // 11 keymap tasks + one per held timed or layer jump key (PRESS_POOL_SIZE) + headroom
+
 //----
-#define COMBO_COUNT 21  // N is the number of combos you want
-#define COMBO_TERM  12  // Combo detection window
-#define EXTRA_SHORT_COMBOS
+#define COMBO_TERM  12  // Combo detection window of the matcher in keymap.c, upper limit for the per-combo terms
+#define COMBO_TERM_PER_COMBO  // Per-combo terms learned from chord skew in keymap.c
 //----
+// #define LATENCY_STATS  // Keypress latency histograms in keymap.c (~600 bytes RAM), read over VIA with Tools/latency_report.py
+// #define STAGE_PROFILE  // Cycle counters per pointing/layer/RPC/LED stage in keymap.c, read over VIA with Tools/stage_report.py
 // Vendor driver is used for RP2040 PIO serial
 #define SERIAL_USART_TX_PIN GP1
 
@@ -15,12 +15,17 @@
  */
 
 #include QMK_KEYBOARD_H
+#include <action_tapping.h>  // action_tapping_process(), the combo matcher replays held back keys through it
 // #include <action.h>
 // #include <math.h> // Only need for advanced math fabsf(), sqrtf()
 
 // Required for RPC communication functions
 #include <split_util.h>
 #include <transactions.h>
+#include <string.h>      // memcpy() for the replicated split state
+#ifdef VIA_ENABLE
+#include "via.h"         // VIA command ids for via_custom_value_command_user()
+#endif
 
 // Required Debugging & Printing
 #ifdef CONSOLE_ENABLE
@@ -33,33 +38,290 @@ bool debug_ms_reports = false;       // Debug mouse reports
 // make lily58/rev1:via:flash -e POINTING_DEVICE=trackball_trackball -e POINTING_DEVICE_POSITION=left -j 8
 // make lily58/rev1:via:flash -e POINTING_DEVICE=trackball_trackball -e POINTING_DEVICE_POSITION=right -j 8
 
-uint16_t    CAPS_TIMER;
 bool        CAPS_ACTIVE = false;
+#define     CAPS_TIMEOUT 30000      // Caps Lock auto-off
 
-uint8_t     LJ_LAYER;
-uint16_t    LJ_RELEASE;
-bool        LJ_ACTIVE = false;
-// Track if delayed layer change is pending per timer pointer
-bool        LJ_PENDING = false;
-uint16_t    LJ_TIMER = 0;
-#define     LAYER_CHANGE_DELAY 200  // Delay before switching layers
+bool        LJ_ACTIVE = false;      // Delayed release pending, cleared by the next layer jump press
+#define     LAYER_CHANGE_DELAY 200  // Delay before switching layers, unless another key is pressed first
+#define     LAYER_EARLY_MIN 100     // Held this long before another key press commits the layer, keeps typing rolls as taps
+#define     LAYER_RELEASE_DELAY 200 // Delay before leaving layers after release
 
 bool        BTN_SWAP = true;        // If true, swap the behavior of O_ & I_ keycodes
-uint8_t     GROWTH_FACTOR = 8;      // Moved here to for runtime adjustments with FX_SLV_M & FX_SLV_P
-uint8_t     RGB_CURRENT;            // Holds current RGB color, Used in mouse handle_mouse_mode_rgb() to prevent unecessary calls
+bool        COMBO_ON = true;        // Combo matching in keymap.c, CM_ON / CM_OFF / CM_TOGG
+#define     GROWTH_FACTOR 8         // Starting growth per trackball, FX_SLV_M & FX_SLV_P adjust each side at runtime
+#define     SCALE_SHIFT 8           // Trackball gains are Q8: 1 << 8 = 1.0x
+#define     MIN_SCALE 1             // Minimum trackball gain (Q8, 1 = 0.004x)
+#define     MAX_SCALE (64 << SCALE_SHIFT)   // Maximum trackball gain (Q8, 64.0x), per ball maxes must stay at or below it
 
 bool        RGB_MS_ACTIVE = false;  // RGB Emulation Mode Arrow/Scroll
 uint16_t    RGB_MS_TIMER;           // Holds Last Move Time
 // Auto Mouse Layer Variables
 bool        ATML = false;           // Off by Default
 bool        ATML_ACTIVE = false;
-uint16_t    ATML_TIMER;
+uint16_t    ATML_TIMER;             // Holds Last Activity Time
 uint16_t    ATML_DELAY = 0;         // Added Delay when key pressed
 
-#define     TIMER_LIMITER 500       // Global limiter to prevent excessive timer_read()'s
 #define     ATML_TIMEOUT 1500       // Auto Mouse Layer Timeout
 #define     RGB_MS_TIMEOUT 1500     // Mouse Mode Timeout
 
+// Deadlines, all timeouts run on defer_exec() instead of being polled
+// Requires DEFERRED_EXEC_ENABLE = yes in rules.mk, MAX_DEFERRED_EXECUTORS in config.h
+static deferred_token lj_release_token = INVALID_DEFERRED_TOKEN;
+static deferred_token caps_token       = INVALID_DEFERRED_TOKEN;
+static deferred_token atml_token       = INVALID_DEFERRED_TOKEN;
+static deferred_token rgb_ms_token     = INVALID_DEFERRED_TOKEN;
+static deferred_token arrow_token      = INVALID_DEFERRED_TOKEN;
+static deferred_token sync_token       = INVALID_DEFERRED_TOKEN;
+static deferred_token macro_token      = INVALID_DEFERRED_TOKEN;
+static deferred_token led_token        = INVALID_DEFERRED_TOKEN;
+static deferred_token combo_token      = INVALID_DEFERRED_TOKEN;
+
+// Schedules or pushes back a deadline. The callback must reset its token when it returns 0.
+static void deadline_set(deferred_token* token, uint32_t delay, deferred_exec_callback callback) {
+    if (*token != INVALID_DEFERRED_TOKEN && extend_deferred_exec(*token, delay)) {
+        return;
+    }
+    *token = defer_exec(delay, callback, NULL);
+}
+
+static void deadline_cancel(deferred_token* token) {
+    if (*token != INVALID_DEFERRED_TOKEN) {
+        cancel_deferred_exec(*token);
+        *token = INVALID_DEFERRED_TOKEN;
+    }
+}
+
+// For activity timeouts: activity only stamps a time, the deadline checks it when it fires
+// and sleeps for whatever is left. Returns 0 once the full timeout has passed with no activity.
+static uint32_t deadline_remaining(uint16_t last_activity, uint16_t timeout) {
+    int16_t elapsed = (int16_t)timer_elapsed(last_activity);    // Negative if stamped ahead with ATML_DELAY
+    return (elapsed < (int16_t)timeout) ? (uint32_t)(timeout - elapsed) : 0;
+}
+
+#ifdef CONSOLE_ENABLE
+// Event Trace
+// Fixed size binary records written into a ring, a handful of stores per event so tracing doesn't
+// shift the timing it's observing. trace_drain_callback() prints them to the console in the
+// background, decode with Tools/trace_decode.py. Recording is on while debug is on (MS_DEBUG or DB_TOGG).
+// Requires CONSOLE_ENABLE = yes and NO_PRINT commented out in rules.mk
+typedef enum {
+    TRACE_KEY_DOWN = 1,     // arg = row << 4 | col, data = keycode, event time
+    TRACE_KEY_UP,           // Same as TRACE_KEY_DOWN
+    TRACE_LAYER,            // arg = highest layer, data = layer_state
+    TRACE_MODE,             // arg = left mode | right mode << 4
+    TRACE_RPC,              // arg = rgb layer, data = btn_swap, atml, modes, sent
+    TRACE_MOUSE_L,          // arg = buttons, data = x, y, h, v clamped to int8
+    TRACE_MOUSE_R,          // Same as TRACE_MOUSE_L
+    TRACE_DROPPED           // arg = records lost to a full ring since the last one
+} trace_type_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t        time;       // timer_read() when recorded
+    uint8_t         type;       // trace_type_t
+    uint8_t         arg;
+    uint8_t         data[4];
+} trace_record_t;
+
+#define TRACE_SIZE          64  // Records, power of 2 (512 bytes)
+#define TRACE_DRAIN_BATCH   4   // Records printed per drain pass
+#define TRACE_DRAIN_INTERVAL 5  // ms between drain passes
+
+static trace_record_t   trace_ring[TRACE_SIZE];
+static uint8_t          trace_head    = 0;      // Free running, masked on access
+static uint8_t          trace_tail    = 0;
+static uint8_t          trace_dropped = 0;
+static deferred_token   trace_token   = INVALID_DEFERRED_TOKEN;
+
+static uint32_t trace_drain_callback(uint32_t trigger_time, void* cb_arg) {
+    static const char hex[] = "0123456789ABCDEF";
+    char line[] = "TR:0000000000000000\n";
+
+    for (uint8_t n = 0; n < TRACE_DRAIN_BATCH && trace_tail != trace_head; n++) {
+        const uint8_t* bytes = (const uint8_t*)&trace_ring[trace_tail & (TRACE_SIZE - 1)];
+        for (uint8_t i = 0; i < sizeof(trace_record_t); i++) {
+            line[3 + i * 2] = hex[bytes[i] >> 4];
+            line[4 + i * 2] = hex[bytes[i] & 0x0F];
+        }
+        trace_tail++;
+        print(line);
+    }
+    if (trace_tail != trace_head) {
+        return TRACE_DRAIN_INTERVAL;
+    }
+    trace_token = INVALID_DEFERRED_TOKEN;
+    return 0;
+}
+
+static void trace_event(uint8_t type, uint8_t arg, uint32_t data) {
+    if (!debug_enable) {
+        return;
+    }
+    if ((uint8_t)(trace_head - trace_tail) >= TRACE_SIZE - 1) {
+        // Keep one slot for the drop marker, newest records are the ones lost
+        if (trace_dropped < UINT8_MAX) {
+            trace_dropped++;
+        }
+        return;
+    }
+    if (trace_dropped) {
+        trace_ring[trace_head++ & (TRACE_SIZE - 1)] = (trace_record_t){timer_read(), TRACE_DROPPED, trace_dropped, {0}};
+        trace_dropped = 0;
+    }
+    trace_record_t* rec = &trace_ring[trace_head++ & (TRACE_SIZE - 1)];
+    rec->time = timer_read();
+    rec->type = type;
+    rec->arg  = arg;
+    memcpy(rec->data, &data, sizeof(rec->data));    // Little endian, same as the decoder expects
+
+    if (trace_token == INVALID_DEFERRED_TOKEN) {
+        trace_token = defer_exec(TRACE_DRAIN_INTERVAL, trace_drain_callback, NULL);
+    }
+}
+
+static inline uint8_t trace_clamp8(int16_t value) {
+    return (uint8_t)(int8_t)(value > INT8_MAX ? INT8_MAX : (value < INT8_MIN ? INT8_MIN : value));
+}
+
+static void trace_key(uint16_t keycode, keyrecord_t* record) {
+    trace_event(record->event.pressed ? TRACE_KEY_DOWN : TRACE_KEY_UP,
+                (record->event.key.row << 4) | (record->event.key.col & 0x0F),
+                keycode | ((uint32_t)record->event.time << 16));
+}
+
+static void trace_mouse(uint8_t type, const report_mouse_t* report) {
+    if (report->x || report->y || report->h || report->v || report->buttons) {
+        trace_event(type, report->buttons,
+                    trace_clamp8(report->x) | (uint32_t)trace_clamp8(report->y) << 8 |
+                    (uint32_t)trace_clamp8(report->h) << 16 | (uint32_t)trace_clamp8(report->v) << 24);
+    }
+}
+#else
+#define trace_event(type, arg, data)
+#define trace_key(keycode, record)
+#define trace_mouse(type, report)
+#endif
+
+#ifdef STAGE_PROFILE
+// Stage Profiling
+// Cycle counts per stage of the pointing pipeline and of the layer, RPC and LED paths, to catch
+// slow work landing in the hot path. Read over VIA with Tools/stage_report.py.
+// The Cortex-M0+ has no DWT cycle counter, SysTick is free on the RP2040 (ChibiOS ticks off the
+// RP timer) so it's run as a free running 24 bit down counter at the core clock, ~126ms per wrap.
+#include <hal.h>
+
+typedef enum profile_stages {
+    STAGE_POINTING,     // Whole pointing_device_task_combined_user()
+    STAGE_BUTTONS,      // handle_mouse_buttons(), both balls
+    STAGE_MOUSE_MODE,   // auto_mouse_layer_handler() or handle_mouse_mode_rgb()
+    STAGE_EMULATION,    // Arrow and scroll emulation
+    STAGE_SCALING,      // pimoroni_adaptive_scaling(), both balls
+    STAGE_COMBINE,      // pointing_device_combine_reports()
+    STAGE_LAYER_STATE,  // layer_state_set_user()
+    STAGE_RPC_SYNC,     // transaction_rpc_send() in sync_slave_callback()
+    STAGE_LED_WRITE,    // led_flush_callback(), I2C write to the trackball
+    STAGE_COUNT
+} profile_stage_t;
+
+typedef struct stage_stat {
+    uint32_t        calls;
+    uint32_t        min;        // Cycles
+    uint32_t        max;
+    uint64_t        total;
+} stage_stat_t;
+
+static stage_stat_t stage_stats[STAGE_COUNT];
+static uint16_t     stage_reports_per_sec = 0;
+
+static void stage_clock_init(void) {
+    if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+        SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+        SysTick->VAL  = 0;
+        SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    }
+    memset(stage_stats, 0, sizeof(stage_stats));
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+        stage_stats[i].min = UINT32_MAX;
+    }
+}
+
+static void stage_record(uint8_t stage, uint32_t start) {
+    uint32_t end    = SysTick->VAL;
+    uint32_t cycles = (start >= end) ? start - end : start + SysTick->LOAD + 1 - end;   // Counts down
+    stage_stat_t* stat = &stage_stats[stage];
+    stat->calls++;
+    stat->total += cycles;
+    if (cycles < stat->min) {
+        stat->min = cycles;
+    }
+    if (cycles > stat->max) {
+        stat->max = cycles;
+    }
+}
+
+// Mouse reports handled over the last full second
+static void stage_count_report(void) {
+    static uint32_t window_start = 0;
+    static uint16_t reports      = 0;
+    reports++;
+    if (timer_elapsed32(window_start) >= 1000) {
+        stage_reports_per_sec = reports;
+        reports      = 0;
+        window_start = timer_read32();
+    }
+}
+
+#define STAGE_BEGIN(stage)  uint32_t stage##_start = SysTick->VAL
+#define STAGE_END(stage)    stage_record(stage, stage##_start)
+
+#ifdef VIA_ENABLE
+// VIA custom channel, see Tools/stage_report.py
+#define STAGE_CHANNEL 0x50      // 'P'
+
+enum stage_values {
+    STAGE_VALUE_INFO,   // Get: stage count, reports per second (uint16 LE), slowest stage by max
+    STAGE_VALUE_STAT,   // Get: data[3] = stage, calls, min, avg, max follow as uint32 LE
+    STAGE_VALUE_RESET   // Set: clear all counters
+};
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    memcpy(out, &value, sizeof(value));     // Little endian
+}
+
+static void stage_via_command(uint8_t* data, uint8_t length) {
+    uint8_t* command_id = &data[0];
+    uint8_t* value_id   = &data[2];
+
+    if (*command_id == id_custom_get_value && *value_id == STAGE_VALUE_INFO) {
+        uint8_t slowest = STAGE_BUTTONS;
+        for (uint8_t i = STAGE_BUTTONS; i < STAGE_COUNT; i++) {
+            if (stage_stats[i].max > stage_stats[slowest].max) {
+                slowest = i;
+            }
+        }
+        data[3] = STAGE_COUNT;
+        data[4] = stage_reports_per_sec & 0xFF;
+        data[5] = stage_reports_per_sec >> 8;
+        data[6] = slowest;
+    } else if (*command_id == id_custom_get_value && *value_id == STAGE_VALUE_STAT && data[3] < STAGE_COUNT && length >= 20) {
+        stage_stat_t* stat = &stage_stats[data[3]];
+        put_u32(&data[4],  stat->calls);
+        put_u32(&data[8],  stat->calls ? stat->min : 0);
+        put_u32(&data[12], stat->calls ? (uint32_t)(stat->total / stat->calls) : 0);
+        put_u32(&data[16], stat->max);
+    } else if (*command_id == id_custom_set_value && *value_id == STAGE_VALUE_RESET) {
+        stage_clock_init();
+    } else {
+        *command_id = id_unhandled;
+    }
+}
+#endif
+#else
+#define STAGE_BEGIN(stage)
+#define STAGE_END(stage)
+#define stage_clock_init()
+#define stage_count_report()
+#endif
+
 // Cache Active Layer
 uint8_t     LAYER_CACHE = 0;
 
@@ -95,6 +357,10 @@ uint8_t     LAYER_CACHE = 0;
 
 // Initialize Function for use before declaration
 static void set_trackball_rgb_for_slave(uint8_t, uint8_t);
+static void sync_mark_dirty(void);
+static uint16_t tapping_term_default(uint16_t);
+static void motion_tables_build(void);
+static bool combo_process(keyrecord_t*);
 /*
 // Unused struct at the moment
 typedef enum incrementer {
@@ -122,53 +388,254 @@ typedef struct mouse_button {
 static btn_state_t  left_button  = {0, false, MODE_OFF};
 static btn_state_t  right_button = {0, false, MODE_OFF};
 
+// Acceleration per trackball for pimoroni_adaptive_scaling(), each ball has its own curve and average
+// so moving one doesn't change the gain of the other. Tune the sides apart with the LEFT_/RIGHT_ defines
+// in config.h, e.g. a precise left ball with a lower growth and max, and a fast right ball.
+// Scales are Q8 (256 = 1.0x), see MIN_SCALE.
+typedef struct trackball_accel {
+    uint8_t         growth;         // Gain added per count of speed, FX_SLV_M / FX_SLV_P adjust it at runtime
+    int32_t         min_scale;      // Gain at rest, Q8
+    int32_t         max_scale;      // Gain ceiling, Q8, at most MAX_SCALE
+    int32_t         factor;         // Q8, EMA of the target gain
+} accel_t;
+
+// Per ball profile, anything config.h leaves out uses the shared value
+#ifndef LEFT_GROWTH_FACTOR
+#    define LEFT_GROWTH_FACTOR  GROWTH_FACTOR
+#endif
+#ifndef LEFT_MIN_SCALE
+#    define LEFT_MIN_SCALE      MIN_SCALE
+#endif
+#ifndef LEFT_MAX_SCALE
+#    define LEFT_MAX_SCALE      MAX_SCALE
+#endif
+#ifndef RIGHT_GROWTH_FACTOR
+#    define RIGHT_GROWTH_FACTOR GROWTH_FACTOR
+#endif
+#ifndef RIGHT_MIN_SCALE
+#    define RIGHT_MIN_SCALE     MIN_SCALE
+#endif
+#ifndef RIGHT_MAX_SCALE
+#    define RIGHT_MAX_SCALE     MAX_SCALE
+#endif
+
+// MAX_TARGET is sized from MAX_SCALE, a higher ceiling would overflow the EMA product
+_Static_assert(LEFT_MAX_SCALE <= MAX_SCALE, "LEFT_MAX_SCALE must be at most MAX_SCALE");
+_Static_assert(RIGHT_MAX_SCALE <= MAX_SCALE, "RIGHT_MAX_SCALE must be at most MAX_SCALE");
+_Static_assert(LEFT_MIN_SCALE <= LEFT_MAX_SCALE && RIGHT_MIN_SCALE <= RIGHT_MAX_SCALE, "min scale above max scale");
+_Static_assert(LEFT_GROWTH_FACTOR >= 1 && LEFT_GROWTH_FACTOR <= UINT8_MAX && RIGHT_GROWTH_FACTOR >= 1
+               && RIGHT_GROWTH_FACTOR <= UINT8_MAX, "growth is a uint8_t, 0 would stop the ball");
+
+static accel_t      left_accel   = {LEFT_GROWTH_FACTOR, LEFT_MIN_SCALE, LEFT_MAX_SCALE, LEFT_MIN_SCALE};
+static accel_t      right_accel  = {RIGHT_GROWTH_FACTOR, RIGHT_MIN_SCALE, RIGHT_MAX_SCALE, RIGHT_MIN_SCALE};
+
+static void accel_adjust(accel_t* accel, int8_t step) {
+    int16_t growth = accel->growth + step;
+    accel->growth = (growth < 1) ? 1 : (growth > UINT8_MAX) ? UINT8_MAX : growth;   // 0 would stop the ball
+}
+
+// Replicated split state
+// The master keeps one packed copy of everything the slave needs and sends only the latest copy,
+// at most once per SYNC_INTERVAL. Bursts of changes collapse into a single transaction.
+typedef struct __attribute__((packed)) {
+    uint8_t         rgb_layer;      // Colour index for the slave trackball
+    bool            btn_swap;       // BTN_SWAP
+    bool            atml;           // ATML
+    uint8_t         modes;          // left_button.mode | right_button.mode << 4
+} sync_state_t;
+
+static sync_state_t sync_state   = {0, true, false, 0};
+static bool         SYNC_DIRTY   = false;
+#define             SYNC_INTERVAL 10        // Min ms between slave syncs
+
+// In-flight press records for timed keys, keyed by matrix position
+// Every held key gets its own press time, so overlapping tap-holds resolve independently
+// and keys that aren't held cost no RAM.
+#define PRESS_POOL_SIZE 8           // Max timed keys held at once, must fit in press_used
+
+typedef struct press_record {
+    keypos_t        key;            // Matrix position of the held key
+    uint16_t        time;           // Press time
+    uint16_t        hold;           // Hold action for timed_hold_handler()
+    deferred_token  token;          // Pending hold action, INVALID_DEFERRED_TOKEN once fired
+    bool            fired;          // Hold action already sent, or layer jump committed
+    bool            repeat;         // Hold action is held down until release
+    uint8_t         layer;          // Layer jump target, 0 for other keys
+} press_t;
+
+static press_t  press_pool[PRESS_POOL_SIZE];
+static uint8_t  press_used = 0;     // Bitmask of slots in use
+
+static inline bool press_same_key(keypos_t a, keypos_t b) {
+    return a.row == b.row && a.col == b.col;
+}
+
+// Claims a free slot on press, NULL if more than PRESS_POOL_SIZE keys are held
+static press_t* press_begin(keyrecord_t* record) {
+    uint8_t free_slots = ~press_used;
+    if (!free_slots) {
+        return NULL;
+    }
+    uint8_t slot = __builtin_ctz(free_slots);
+    press_used |= 1 << slot;
+    press_pool[slot].key   = record->event.key;
+    press_pool[slot].time  = record->event.time;
+    press_pool[slot].token = INVALID_DEFERRED_TOKEN;
+    press_pool[slot].fired = false;
+    press_pool[slot].layer = 0;
+    return &press_pool[slot];
+}
+
+// Finds the slot claimed by the press of the same key
+static press_t* press_find(keyrecord_t* record) {
+    for (uint8_t used = press_used; used; used &= used - 1) {
+        uint8_t slot = __builtin_ctz(used);
+        if (press_same_key(press_pool[slot].key, record->event.key)) {
+            return &press_pool[slot];
+        }
+    }
+    return NULL;
+}
+
+static void press_end(press_t* press) {
+    if (press) {
+        press_used &= ~(1 << (press - press_pool));
+    }
+}
+
+// Finds and frees the press record on release. Returns how long the key was held,
+// 0 if there was no record (pool was full on press), which resolves as a tap.
+static uint16_t press_release(keyrecord_t* record) {
+    press_t* press = press_find(record);
+    if (!press) {
+        return 0;
+    }
+    uint16_t held = TIMER_DIFF_16(record->event.time, press->time);
+    press_end(press);
+    return held;
+}
+
+// Batched layer change, applies the final mask with a single layer_state_set()
+// One layer_state_set_user() run, one slave sync and one LED update instead of one per layer_on()/layer_off()
+#define LAYER_BIT(layer)    ((layer_state_t)1 << (layer))
+
+static void layer_apply(layer_state_t on_mask, layer_state_t off_mask) {
+    layer_state_t state = (layer_state & ~off_mask) | on_mask;
+    if (state != layer_state) {
+        layer_state_set(state);
+    }
+}
+
+static layer_state_t lj_layers = 0;     // Layers reachable through layer jump keys, built from dual_keys[] at boot
+
+// Jump keys still held are cancelled, their deadline can't bring the layer back and release won't tap
+// Their records stay until release, which frees them whichever way BTN_SWAP points by then
 static void layer_jump_timeout(void) {
-    layer_off(1);
-    layer_off(2);
-    layer_off(3);
-    layer_off(4);
-    LJ_LAYER = 0;
+    for (uint8_t used = press_used; used; used &= used - 1) {
+        press_t* press = &press_pool[__builtin_ctz(used)];
+        if (press->layer) {
+            deadline_cancel(&press->token);
+            press->fired = true;
+        }
+    }
+    layer_apply(0, LAYER_BIT(1) | LAYER_BIT(2) | LAYER_BIT(3) | LAYER_BIT(4));
     LJ_ACTIVE = false;
 }
 
-// Process delayed layer change when delay expires
-static void layer_jump_delay_handler(void) {
-    // Turn off the other layer and enable the delayed one
-    layer_off(LJ_LAYER == 1 ? 2 : 1);
-    layer_on(LJ_LAYER);
-    LJ_ACTIVE = false;
-    LJ_PENDING = false;
+// Layer on, every other jump layer off
+static void layer_jump_enter(uint8_t layer) {
+    layer_apply(LAYER_BIT(layer), lj_layers & ~LAYER_BIT(layer));
+}
+
+static void layer_jump_commit(press_t* press) {
+    deadline_cancel(&press->token);
+    press->fired = true;
+    layer_jump_enter(press->layer);
+}
+
+// Per key deadline, the layer goes on exactly LAYER_CHANGE_DELAY after the press
+static uint32_t layer_jump_commit_callback(uint32_t trigger_time, void* cb_arg) {
+    press_t* press = (press_t*)cb_arg;
+    press->token = INVALID_DEFERRED_TOKEN;
+    layer_jump_commit(press);
+    return 0;
+}
+
+// Another key went down while jumps are pending, commit them now so that key already lands on the jump layer
+// Presses sooner than LAYER_EARLY_MIN after the jump key are rolls while typing and leave it pending
+// Called from key_press_observe(), before the key is looked up in the keymap
+static void layer_jump_interrupt(keyrecord_t* record) {
+    for (uint8_t used = press_used; used; used &= used - 1) {
+        press_t* press = &press_pool[__builtin_ctz(used)];
+        if (press->layer && !press->fired && !press_same_key(press->key, record->event.key)
+            && TIMER_DIFF_16(record->event.time, press->time) >= LAYER_EARLY_MIN) {
+            layer_jump_commit(press);
+        }
+    }
+}
+
+static bool layer_jump_held(void) {
+    for (uint8_t used = press_used; used; used &= used - 1) {
+        if (press_pool[__builtin_ctz(used)].layer) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Delayed release, skipped if a new press came first or another jump key is still held
+static uint32_t layer_jump_release_callback(uint32_t trigger_time, void* cb_arg) {
+    lj_release_token = INVALID_DEFERRED_TOKEN;
+    if (LJ_ACTIVE && !layer_jump_held()) {
+        layer_jump_timeout();
+    }
+    return 0;
 }
 
 static bool layer_jump_handler(
     uint16_t        tap_key,        // keycode to send on tap
     uint16_t        alt_key,        // keycode to register/unregister on hold
     uint8_t         layer,          // layer to activate on hold
-    uint16_t*       timer,          // single shared timer pointer for tap and delay
     bool            condition,      // true = enter layer/hold branch, false = tap branch
     keyrecord_t* record) {
 
     if (record->event.pressed) {
         if (condition) {
-                                    // Sets up delayed layer change
-            LJ_LAYER = layer;       // Layer to change to
-            LJ_TIMER = *timer = timer_read();
-            LJ_PENDING = true;      // Sets up for delayed layer activation
             LJ_ACTIVE = false;      // Cancels delayed release on double tap
+            // Each key keeps its own state and deadline, the layer commits at the deadline
+            // or as soon as another key is pressed, whichever comes first
+            press_t* press = press_begin(record);
+            if (press) {
+                press->layer = layer;
+                press->token = defer_exec(LAYER_CHANGE_DELAY, layer_jump_commit_callback, press);
+            }
+            if (!press || press->token == INVALID_DEFERRED_TOKEN) {
+                layer_jump_enter(layer);    // Out of slots, no tap possible, go straight to the layer
+                press_end(press);
+            }
         } else {
+            // The record remembers which branch the press took, B_SWAP may flip condition before release
+            press_begin(record);
             register_code16(alt_key);
         }
     } else {
-        if (condition) {
+        // Branch from the press record, condition only when the pool was full on press
+        press_t* press = press_find(record);
+        if (press ? press->layer != 0 : condition) {
             // Sets up for delayed release
-            LJ_RELEASE = timer_read();
             LJ_ACTIVE = true;
-
-            if (timer_elapsed(*timer) < TAPPING_TERM) {
-                tap_code16(tap_key);
-                LJ_PENDING = false;  // Cancel delayed release change on tap
+            deadline_set(&lj_release_token, LAYER_RELEASE_DELAY, layer_jump_release_callback);
+
+            if (press) {
+                bool tap = !press->fired && TIMER_DIFF_16(record->event.time, press->time) < TAPPING_TERM;
+                deadline_cancel(&press->token);     // Released before the deadline, the layer never goes on
+                press_end(press);
+                if (tap) {
+                    tap_code16(tap_key);
+                }
             }
         } else {
+            press_end(press);
             unregister_code16(alt_key);
         }
     }
@@ -179,48 +646,81 @@ static bool layer_jump_handler(
 static bool tap_hold_handler(
     uint16_t        tap_key,    // Tap Key
     uint16_t        alt_key,    // Hold Key
-    uint16_t*       timer,      // Timer
     bool            condition,  // Bool Variable
     bool            MB,         // flag to disable MouseButton timer
     keyrecord_t*    record) {
 
-    if (timer == NULL) {
-        // This is for Mouse Keys Swapping or if BTN_SWAP is toggled
-        // If no timer provided, just do simple tap/hold without timing
-        // Resets Mouse Mode timer in handle_mouse_mode_rgb()
-        /* Haven't really used.
-        if (is_caps_word_on()) {
-            add_weak_mods(MOD_BIT(KC_LSFT));
-        }*/
-        if (condition) {
-            record->event.pressed ? register_code16(tap_key) : unregister_code16(tap_key);
-        } else {
-            record->event.pressed ? register_code16(alt_key) : unregister_code16(alt_key);
-            if (MB) { // Resets timers for auto swapping keys/layers
-                uint16_t now = timer_read();
-                if (RGB_MS_ACTIVE && timer_elapsed(RGB_MS_TIMER) > TIMER_LIMITER) {
-                    RGB_MS_TIMER = now;
-                }
-                if (ATML_ACTIVE && timer_elapsed(ATML_TIMER) > TIMER_LIMITER) {
-                    ATML_TIMER = now + ATML_DELAY;
-                }
+    // This is for Mouse Keys Swapping or if BTN_SWAP is toggled
+    // No timing, just simple tap/hold picked by condition
+    // Resets Mouse Mode timer in handle_mouse_mode_rgb()
+    /* Haven't really used.
+    if (is_caps_word_on()) {
+        add_weak_mods(MOD_BIT(KC_LSFT));
+    }*/
+    if (condition) {
+        record->event.pressed ? register_code16(tap_key) : unregister_code16(tap_key);
+    } else {
+        record->event.pressed ? register_code16(alt_key) : unregister_code16(alt_key);
+        if (MB) { // Resets timers for auto swapping keys/layers
+            uint16_t now = timer_read();
+            if (RGB_MS_ACTIVE) {
+                RGB_MS_TIMER = now;
+            }
+            if (ATML_ACTIVE) {
+                ATML_TIMER = now + ATML_DELAY;
             }
         }
+    }
+    return false;
+}
+
+// Fires the hold action as soon as the tapping term passes, without waiting for release
+static uint32_t hold_fire_callback(uint32_t trigger_time, void* cb_arg) {
+    press_t* press = (press_t*)cb_arg;
+    press->token = INVALID_DEFERRED_TOKEN;
+    press->fired = true;
+    if (press->repeat) {
+        register_code16(press->hold);   // Held until release, host auto-repeat takes over
     } else {
-        // If timer provided, do timed tap/hold behavior
-        if (record->event.pressed) {
-                *timer = timer_read();
-            // Reset Auto Mouse Layer Timeout if keys are used
-            if (ATML_ACTIVE && timer_elapsed(ATML_TIMER) > TIMER_LIMITER) {
-                ATML_TIMER = *timer;
+        tap_code16(press->hold);
+    }
+    return 0;
+}
+
+// Timed tap/hold keys, tap_key on release before term, hold_key the moment term passes
+// Generalizes BSPC_H from Example_Routines/Examples-Tap_Repeat_on_Hold.c without matrix_scan_user()
+static bool timed_hold_handler(
+    uint16_t        tap_key,    // Tap Key
+    uint16_t        hold_key,   // Hold Key
+    bool            repeat,     // Keep hold_key down until release so it repeats
+    uint16_t        term,       // Tapping term for this key
+    keyrecord_t*    record) {
+
+    if (record->event.pressed) {
+        press_t* press = press_begin(record);
+        if (press) {
+            press->hold   = hold_key;
+            press->repeat = repeat;
+            press->token  = defer_exec(term, hold_fire_callback, press);
+        }
+        // Reset Auto Mouse Layer Timeout if keys are used
+        if (ATML_ACTIVE) {
+            ATML_TIMER = record->event.time;
+        }
+    } else {
+        press_t* press = press_find(record);
+        if (!press) {
+            tap_code16(tap_key);        // No record, pool was full on press
+        } else if (press->fired) {
+            if (press->repeat) {
+                unregister_code16(hold_key);
             }
         } else {
-            if (timer_elapsed(*timer) < TAPPING_TERM) {
-                tap_code16(tap_key);
-            } else {
-                tap_code16(alt_key);
-            }
+            deadline_cancel(&press->token);
+            // Executor was full if the hold time already passed term, resolve it here instead
+            tap_code16((TIMER_DIFF_16(record->event.time, press->time) < term) ? tap_key : hold_key);
         }
+        press_end(press);
     }
     return false;
 }
@@ -265,296 +765,1029 @@ enum custom_keycodes {
     PU_PD,                  // 99
     HM_EN,                  // 100
     R_SHIFT,                // 101
-    L_SHIFT
-//    MS_DEBUG,
+    L_SHIFT,
+#ifdef CONSOLE_ENABLE
+    MS_DEBUG,               // Toggles debug output and the event trace
+#endif
+};
+
+// Dual-function key table, indexed by keycode - SAFE_RANGE
+// Adding a tap/hold or layer jump key is one line here, process_record_user() looks it up directly
+typedef enum dual_key_kinds {
+    DK_NONE,            // Not in the table, handled by the switch in process_record_user()
+    DK_LAYER,           // layer_jump_handler(), jumps when BTN_SWAP
+    DK_LAYER_INV,       // layer_jump_handler(), jumps when !BTN_SWAP
+    DK_MOUSE,           // tap_hold_handler() untimed, hold key while RGB_MS_ACTIVE
+    DK_AUTO_MOUSE,      // tap_hold_handler() untimed, hold key while ATML_ACTIVE
+    DK_TIMED,           // timed_hold_handler(), hold key tapped once the term passes
+    DK_REPEAT           // timed_hold_handler(), hold key held from the term until release
+} dk_kind_t;
+
+typedef struct dual_key {
+    uint16_t        tap;        // Tap Key
+    uint16_t        hold;       // Hold Key
+    uint8_t         kind;       // dk_kind_t
+    uint8_t         layer;      // Layer for DK_LAYER / DK_LAYER_INV
+} dual_key_t;
+
+static const dual_key_t PROGMEM dual_keys[] = {
+    [O_CAPS_L1 - SAFE_RANGE] = {KC_SPC,         KC_CAPS,        DK_LAYER,       1},
+    [O_SPC_L2  - SAFE_RANGE] = {KC_NO,          KC_NO,          DK_LAYER,       2},
+    [I_SPC_L1  - SAFE_RANGE] = {KC_CAPS,        KC_SPC,         DK_LAYER_INV,   1},
+    [I_SPC_L2  - SAFE_RANGE] = {KC_NO,          KC_NO,          DK_LAYER_INV,   2},
+    // Group for mouse buttons with tap-hold behavior
+    // _MB* are toggled by RGB_MS_ACTIVE to change to mouse buttons on mouse move
+    [R_MB1     - SAFE_RANGE] = {KC_Y,           KC_MS_BTN1,     DK_MOUSE,       0},
+    [R_MB2     - SAFE_RANGE] = {KC_U,           KC_MS_BTN2,     DK_MOUSE,       0},
+    [L_MB1     - SAFE_RANGE] = {KC_T,           KC_MS_BTN1,     DK_MOUSE,       0},
+    [L_MB2     - SAFE_RANGE] = {KC_R,           KC_MS_BTN2,     DK_MOUSE,       0},
+    [R_SHIFT   - SAFE_RANGE] = {KC_K,           KC_LSFT,        DK_MOUSE,       0},
+    [L_SHIFT   - SAFE_RANGE] = {KC_D,           KC_LSFT,        DK_MOUSE,       0},
+    [ML_MB1    - SAFE_RANGE] = {KC_MS_BTN1,     KC_MS_BTN1,     DK_AUTO_MOUSE,  0},
+    [ML_MB2    - SAFE_RANGE] = {KC_MS_BTN2,     KC_MS_BTN2,     DK_AUTO_MOUSE,  0},
+    // Timed tap & hold
+    [ESC_GRV   - SAFE_RANGE] = {KC_ESC,         KC_GRV,         DK_TIMED,       0},
+    [LTB_BK    - SAFE_RANGE] = {RCS(KC_TAB),    KC_WWW_BACK,    DK_TIMED,       0}, // LEFT TAB & BACKWARD
+    [RTB_FW    - SAFE_RANGE] = {RCTL(KC_TAB),   KC_WWW_FORWARD, DK_TIMED,       0}, // RIGHT TAB & FORWARD
+    [CT_UN     - SAFE_RANGE] = {RCTL(KC_W),     RCS(KC_T),      DK_TIMED,       0}, // CLOSE TAB & UNDO CLOSE TAB
+    [CW_LW     - SAFE_RANGE] = {A(KC_TAB),      A(KC_ESC),      DK_TIMED,       0}, // LAST WINDOW & CYCLE WINDOWS
+    [NX_PR     - SAFE_RANGE] = {KC_MNXT,        KC_MPRV,        DK_TIMED,       0}, // NEXT & PREVIOUS
+    [UN_RE     - SAFE_RANGE] = {C(KC_Z),        C(KC_Y),        DK_REPEAT,      0}, // UNDO & REDO
+    [CO_PA     - SAFE_RANGE] = {C(KC_C),        C(KC_V),        DK_TIMED,       0}, // COPY & PASTE
+    [VU_VD     - SAFE_RANGE] = {KC_VOLU,        KC_VOLD,        DK_REPEAT,      0}, // VOLUME UP & VOLUME DOWN
+    [CT_TW     - SAFE_RANGE] = {G(KC_T),        LCA(KC_TAB),    DK_TIMED,       0}, // CYCLE TASKBAR & TAB CYCLE WINDOWS
+    [DE_CU     - SAFE_RANGE] = {KC_DEL,         C(KC_X),        DK_TIMED,       0}, // DELETE & CUT
+    [CW_FS     - SAFE_RANGE] = {A(KC_F4),       KC_F11,         DK_TIMED,       0}, // CLOSE WINDOW & FULLSCREEN
+    [DL_DR     - SAFE_RANGE] = {G(C(KC_LEFT)),  G(C(KC_RIGHT)), DK_TIMED,       0}, // VIRTUAL DESKOP LEFT & VIRTUAL DESKTOP RIGHT
+    [PU_PD     - SAFE_RANGE] = {KC_PGUP,        KC_PGDN,        DK_REPEAT,      0}, // Page Up & Page Down
+    [HM_EN     - SAFE_RANGE] = {KC_HOME,        KC_END,         DK_TIMED,       0}, // Home & End
+};
+
+// dk_kind_t of a keycode, DK_NONE if it's not in the table
+static uint8_t dual_key_kind(uint16_t keycode) {
+    uint16_t index = keycode - SAFE_RANGE;  // Wraps around for keycodes below SAFE_RANGE
+    return (index < ARRAY_SIZE(dual_keys)) ? pgm_read_byte(&dual_keys[index].kind) : DK_NONE;
+}
+
+static inline bool dual_key_is_layer_jump(uint16_t keycode) {
+    uint8_t kind = dual_key_kind(keycode);
+    return kind == DK_LAYER || kind == DK_LAYER_INV;
+}
+
+// Layers the jump keys can enter, entering one turns the others off
+static void layer_jump_init(void) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(dual_keys); i++) {
+        if (dual_key_is_layer_jump(SAFE_RANGE + i)) {
+            lj_layers |= LAYER_BIT(pgm_read_byte(&dual_keys[i].layer));
+        }
+    }
+}
+
+// Returns true if keycode was a table entry and has been handled
+static bool dual_key_dispatch(
+    uint16_t        keycode,
+    keyrecord_t*    record,
+    bool*           result) {
+
+    uint16_t index = keycode - SAFE_RANGE;  // Wraps around for keycodes below SAFE_RANGE
+    if (index >= ARRAY_SIZE(dual_keys)) {
+        return false;
+    }
+    dual_key_t key;
+    memcpy_P(&key, &dual_keys[index], sizeof(key));
+
+    switch (key.kind) {
+        case DK_LAYER:
+            *result = layer_jump_handler(key.tap, key.hold, key.layer, BTN_SWAP, record);
+            return true;
+        case DK_LAYER_INV:
+            *result = layer_jump_handler(key.tap, key.hold, key.layer, !BTN_SWAP, record);
+            return true;
+        case DK_MOUSE:
+            *result = tap_hold_handler(key.tap, key.hold, !RGB_MS_ACTIVE, true, record);
+            return true;
+        case DK_AUTO_MOUSE:
+            *result = tap_hold_handler(key.tap, key.hold, !ATML_ACTIVE, true, record);
+            return true;
+        case DK_TIMED:
+        case DK_REPEAT:
+            *result = timed_hold_handler(key.tap, key.hold, key.kind == DK_REPEAT, get_tapping_term(keycode, record), record);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Asynchronous macro player
+// A macro is a PROGMEM step list run from the deferred executor, one character or action per call.
+// Delays just reschedule the player, so the matrix scan, split transport and trackballs keep running.
+typedef enum macro_ops {
+    MACRO_END,          // Last step
+    MACRO_SEND,         // Type text, one send_batch() per call
+    MACRO_DELAY,        // Wait arg ms
+    MACRO_DOWN,         // register_code16(arg)
+    MACRO_UP,           // unregister_code16(arg)
+    MACRO_TAP           // tap_code16(arg)
+} macro_op_t;
+
+typedef struct macro_step {
+    uint8_t         op;         // macro_op_t
+    uint16_t        arg;        // Keycode or delay
+    const char*     text;       // Text for MACRO_SEND
+} macro_step_t;
+
+#define MACRO_CHAR_INTERVAL 1   // ms between typed batches
+#define SEND_BATCH_MAX 16       // Max keys pressed together in one NKRO report
+
+// Shift state for an ASCII character, same lookup send_string() uses
+static inline bool ascii_needs_shift(uint8_t c) {
+    return (pgm_read_byte(&ascii_to_shift_lut[c >> 3]) >> (c & 7)) & 1;
+}
+
+// Types the longest run of text that fits in one NKRO report and returns where the next run starts.
+// A run shares one shift state and has strictly increasing keycodes: the host reads the NKRO bitmap
+// in usage order, so increasing keycodes come out in string order and repeats always split the run.
+// Without NKRO it falls back to one character per press/release pair, like send_string().
+static const char* send_batch(const char* text) {
+    bool    shift = false;
+    uint8_t max   = 1;
+#ifdef NKRO_ENABLE
+    if (keymap_config.nkro) {
+        max = SEND_BATCH_MAX;
+    }
+#endif
+
+    uint8_t keys[SEND_BATCH_MAX];
+    uint8_t count = 0;
+    uint8_t last  = 0;
+    while (*text && count < max) {
+        uint8_t c       = (uint8_t)*text & 0x7F;
+        uint8_t keycode = pgm_read_byte(&ascii_to_keycode_lut[c]);
+        if (keycode == KC_NO) {
+            text++;
+            continue;   // Not typeable, skipped like send_string() does
+        }
+        // The first typeable character sets the run's shift state
+        if (!count) {
+            shift = ascii_needs_shift(c);
+        } else if (keycode <= last || ascii_needs_shift(c) != shift) {
+            break;
+        }
+        text++;
+        keys[count++] = last = keycode;
+    }
+    if (!count) {
+        return text;
+    }
+
+    if (shift) {
+        add_weak_mods(MOD_BIT(KC_LSFT));
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        add_key(keys[i]);
+    }
+    send_keyboard_report();
+    for (uint8_t i = 0; i < count; i++) {
+        del_key(keys[i]);
+    }
+    if (shift) {
+        del_weak_mods(MOD_BIT(KC_LSFT));
+    }
+    send_keyboard_report();
+    return text;
+}
+
+static const macro_step_t PROGMEM se_pw_macro[] = {
+    {MACRO_SEND,    0,      " "},
+    {MACRO_DELAY,   200,    NULL},
+    {MACRO_SEND,    0,      "2326"},
+    {MACRO_END,     0,      NULL}
 };
 
+static const macro_step_t*  macro_pc   = NULL;  // Current step
+static const char*          macro_char = NULL;  // Next character of the current MACRO_SEND
+
+static uint32_t macro_callback(uint32_t trigger_time, void* cb_arg) {
+    while (true) {
+        macro_step_t step;
+        memcpy_P(&step, macro_pc, sizeof(step));
+
+        switch (step.op) {
+            case MACRO_SEND:
+                if (!macro_char) {
+                    macro_char = step.text;
+                }
+                if (*macro_char) {
+                    macro_char = send_batch(macro_char);
+                    return MACRO_CHAR_INTERVAL;
+                }
+                macro_char = NULL;
+                break;
+            case MACRO_DELAY:
+                macro_pc++;
+                return step.arg;
+            case MACRO_DOWN:
+                register_code16(step.arg);
+                break;
+            case MACRO_UP:
+                unregister_code16(step.arg);
+                break;
+            case MACRO_TAP:
+                tap_code16(step.arg);
+                break;
+            default:
+                macro_pc    = NULL;
+                macro_token = INVALID_DEFERRED_TOKEN;
+                return 0;
+        }
+        macro_pc++;
+    }
+}
+
+// Starts a macro, ignored while another one is still playing
+static void macro_play(const macro_step_t* macro) {
+    if (macro_pc) {
+        return;
+    }
+    macro_pc    = macro;
+    macro_char  = NULL;
+    macro_token = defer_exec(1, macro_callback, NULL);
+    if (macro_token == INVALID_DEFERRED_TOKEN) {
+        macro_pc = NULL;
+    }
+}
+
 // Custom Keycodes End
-bool process_record_user(
+static bool process_record_keymap(
     uint16_t        keycode,
     keyrecord_t*    record) {
 
-    static uint16_t le1_timer;
-    static uint16_t ld1_timer;
-    static uint16_t ri1_timer;
-    static uint16_t rd1_timer;
+    trace_key(keycode, record);
+
+    // Table driven dual-function keys, one lookup instead of a compare chain
+    bool result;
+    if (dual_key_dispatch(keycode, record, &result)) {
+        return result;
+    }
 
     switch (keycode) {
         case KC_UP:
         case KC_DOWN:
         case KC_LEFT:
         case KC_RIGHT:
-            if (ATML_ACTIVE && timer_elapsed(ATML_TIMER) > TIMER_LIMITER) {
+            if (ATML_ACTIVE) {
                 ATML_TIMER = timer_read();
             }
             return true;
 
-        case O_CAPS_L1:
-            return layer_jump_handler(KC_SPC, KC_CAPS, 1, &le1_timer, BTN_SWAP, record);
+#ifdef CONSOLE_ENABLE
+        case MS_DEBUG:
+            if (record->event.pressed) {
+                debug_enable = !debug_enable;  // Toggle debug output
+                if (debug_enable) {
+                    uprintf("Debug Enabled\n");
+                } else {
+                    uprintf("Debug Disabled\n");
+                }
+            }
+            return false;
+#endif
+        // On shift, backspace turns to KC_KEY
+        case BSPC_MINS:
+            if (record->event.pressed) {
+                press_begin(record);
+                if (get_mods() & MOD_MASK_SHIFT) {
+                    register_code(KC_MINS);
+                }
+            } else {
+                // Shift NOT held AND tap duration less than TAPPING_TERM to send Backspace
+                uint16_t held = press_release(record);
+                if (!(get_mods() & MOD_MASK_SHIFT) && (held < TAPPING_TERM)) {
+                    tap_code(KC_BSPC);
+                } else {
+                    if (get_mods() & MOD_MASK_SHIFT) {
+                        unregister_code(KC_MINS);
+                    } else {
+                        tap_code(KC_MINS);
+                    }
+                }
+            }
+            return false;
+
+        // Toggle Button Swap for MB* keys
+        case B_SWAP:
+            if (record->event.pressed) {
+                BTN_SWAP = !BTN_SWAP;
+                sync_mark_dirty();
+                layer_jump_timeout();
+                set_trackball_rgb_for_slave(0, 2);
+            }
+            return false;
+        // Toggles Auto Mouse Layer
+        case ML_AUTO:
+            if (record->event.pressed) {
+                ATML = !ATML;
+                sync_mark_dirty();
+            }
+            layer_jump_timeout();
+            set_trackball_rgb_for_slave(3, 2);
+            return false;
+        // Incrementer, Left Shift held = left ball only, Right Shift held = right ball only, else both
+        case FX_SLV_M: // Reduce growth factor
+        case FX_SLV_P: // Increase growth factor
+            if (record->event.pressed) {
+                uint8_t mods = get_mods();
+                bool    left  = !(mods & MOD_BIT(KC_RSFT)) || (mods & MOD_BIT(KC_LSFT));
+                bool    right = !(mods & MOD_BIT(KC_LSFT)) || (mods & MOD_BIT(KC_RSFT));
+                int8_t  step  = (keycode == FX_SLV_P) ? 1 : -1;
+                if (left) {
+                    accel_adjust(&left_accel, step);
+                }
+                if (right) {
+                    accel_adjust(&right_accel, step);
+                }
+            }
+            return false;
+
+        case SE_PW:
+            if (record->event.pressed) {
+                macro_play(se_pw_macro);
+
+            /* Requires SEND_STRING_ENABLE = yes in rules.mk */
+            }
+            return false;
+
+        // Combos are matched in keymap.c, QMK's combo keycodes only work with COMBO_ENABLE
+        case CM_ON:
+        case CM_OFF:
+        case CM_TOGG:
+            if (record->event.pressed) {
+                COMBO_ON = (keycode == CM_TOGG) ? !COMBO_ON : (keycode == CM_ON);
+            }
+            return false;
+    }
+    return true;
+}
+
+#ifdef TAPPING_TERM_ADAPT
+// Tapping Term Adaptation
+// Each adapted key keeps two small histograms in 16ms buckets:
+//   tap   press to release of single taps (tap.count == 1)
+//   hold  press to the first other key press or trackball click, or to release if nothing else was pressed
+//         Permissive hold keys sample the release, their term only decides holds with no key tapped inside
+// The term moves to the valley between them, the cut that misreads the fewest presses. A tap misread
+// as a hold counts double. Taps slower than the current term come out as holds, so a lone press
+// released before the default term, with no other key pressed and no trackball use, is sampled as a tap.
+// That's how the term climbs back when taps get slower. Clamped to [default / 2, default].
+// Persisted in the EEPROM user datablock, requires EECONFIG_USER_DATA_SIZE in config.h
+#define ADAPT_BUCKET_MS     16
+#define ADAPT_BUCKETS       16      // 0-255ms, holds past that land in the last bucket
+#define ADAPT_MIN_TAPS      32      // Samples needed before the default is left
+#define ADAPT_MIN_HOLDS     8
+#define ADAPT_TAP_WEIGHT    2
+#define ADAPT_SAVE_INTERVAL 600000  // Batched EEPROM write, 10 min after the first new sample
+
+// Keys with a learned term, LT(4,KC_NO) is never adapted, it must stay an instant hold
+static const uint16_t PROGMEM adapt_keys[] = {
+    MT_F, MT_G, MT_H, MT_J,
+    MT(MOD_LALT,KC_DEL),
+    LT(1, KC_MPLY),
+    LT(2, KC_MUTE),
+    LT(2, KC_TAB),
+};
+#define ADAPT_KEYS  ARRAY_SIZE(adapt_keys)
+
+typedef struct {
+    uint8_t         tap[ADAPT_BUCKETS];
+    uint8_t         hold[ADAPT_BUCKETS];
+} adapt_hist_t;
+
+_Static_assert(sizeof(adapt_hist_t[ADAPT_KEYS]) == EECONFIG_USER_DATA_SIZE, "EECONFIG_USER_DATA_SIZE must match adapt_hist");
+_Static_assert(ADAPT_KEYS <= 8, "adapt_dirty and adapt_held are 8 bit masks");
+
+static adapt_hist_t     adapt_hist[ADAPT_KEYS];
+static uint16_t         adapt_term[ADAPT_KEYS];     // Learned term per key, the default until enough samples
+static uint16_t         adapt_press[ADAPT_KEYS];    // Press time of the held key
+static uint16_t         adapt_first[ADAPT_KEYS];    // Press to first other key press, UINT16_MAX if none yet
+static uint8_t          adapt_held  = 0;            // Adapted keys down, bitmask
+static uint8_t          adapt_moved = 0;            // Adapted keys held while the trackball moved, bitmask
+static uint8_t          adapt_dirty = 0;            // Keys with samples not yet in EEPROM, bitmask
+static deferred_token   adapt_token = INVALID_DEFERRED_TOKEN;
+
+static int8_t adapt_index(uint16_t keycode) {
+    for (uint8_t i = 0; i < ADAPT_KEYS; i++) {
+        if (pgm_read_word(&adapt_keys[i]) == keycode) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Term from the valley between the tap and hold histograms, the default until both have enough samples
+static uint16_t adapt_compute(uint8_t index) {
+    const adapt_hist_t* hist = &adapt_hist[index];
+    uint16_t term = tapping_term_default(pgm_read_word(&adapt_keys[index]));
+
+    uint16_t taps = 0, holds = 0;
+    for (uint8_t b = 0; b < ADAPT_BUCKETS; b++) {
+        taps  += hist->tap[b];
+        holds += hist->hold[b];
+    }
+    if (taps < ADAPT_MIN_TAPS || holds < ADAPT_MIN_HOLDS) {
+        return term;
+    }
+
+    // Cut c resolves presses shorter than c * ADAPT_BUCKET_MS as taps
+    // misread(c) = taps at or past the cut * weight + holds before it
+    uint16_t misread = taps * ADAPT_TAP_WEIGHT;     // c = 0
+    uint16_t best = UINT16_MAX;
+    uint8_t  first = 0, last = 0;                   // Run of cuts sharing the lowest misread count
+    for (uint8_t c = 1; c <= ADAPT_BUCKETS; c++) {
+        misread += hist->hold[c - 1] - hist->tap[c - 1] * ADAPT_TAP_WEIGHT;
+        if (misread < best) {
+            best  = misread;
+            first = last = c;
+        } else if (misread == best && last == c - 1) {
+            last = c;
+        }
+    }
+    uint16_t learned = (uint16_t)(first + last) * ADAPT_BUCKET_MS / 2;
+    return MAX(term / 2, MIN(learned, term));
+}
+
+static uint32_t adapt_save_callback(uint32_t trigger_time, void* cb_arg) {
+    adapt_token = INVALID_DEFERRED_TOKEN;
+    // Only keys with new samples, the driver also skips bytes that didn't change
+    for (uint8_t dirty = adapt_dirty; dirty; dirty &= dirty - 1) {
+        uint8_t i = __builtin_ctz(dirty);
+        eeconfig_update_user_datablock(&adapt_hist[i], i * sizeof(adapt_hist_t), sizeof(adapt_hist_t));
+    }
+    adapt_dirty = 0;
+    return 0;
+}
+
+static void adapt_sample(uint8_t index, bool tap, uint16_t ms) {
+    adapt_hist_t* hist = &adapt_hist[index];
+    uint8_t* bucket = &(tap ? hist->tap : hist->hold)[MIN(ms / ADAPT_BUCKET_MS, ADAPT_BUCKETS - 1)];
+    if (*bucket == UINT8_MAX) {
+        // Ages both histograms, recent typing outweighs old samples
+        for (uint8_t b = 0; b < ADAPT_BUCKETS; b++) {
+            hist->tap[b]  >>= 1;
+            hist->hold[b] >>= 1;
+        }
+    }
+    (*bucket)++;
+    adapt_term[index] = adapt_compute(index);
+
+    adapt_dirty |= 1 << index;
+    if (adapt_token == INVALID_DEFERRED_TOKEN) {
+        // No free executor leaves it invalid, the next sample tries again
+        adapt_token = defer_exec(ADAPT_SAVE_INTERVAL, adapt_save_callback, NULL);
+    }
+}
+
+// First other key or trackball click while an adapted key is down is where a hold was wanted
+static void adapt_hold_wanted(uint16_t time) {
+    for (uint8_t held = adapt_held; held; held &= held - 1) {
+        uint8_t i = __builtin_ctz(held);
+        if (adapt_first[i] == UINT16_MAX) {
+            adapt_first[i] = TIMER_DIFF_16(time, adapt_press[i]);
+        }
+    }
+}
+
+// From key_press_observe(), in matrix order before the chord and tapping buffers hold anything back
+static void adapt_key_down(uint16_t keycode, keyrecord_t* record) {
+    adapt_hold_wanted(record->event.time);
+    int8_t index = adapt_index(keycode);
+    if (index >= 0) {
+        adapt_press[index] = record->event.time;
+        adapt_first[index] = UINT16_MAX;
+        adapt_held |= 1 << index;
+        adapt_moved &= ~(1 << index);
+    }
+}
+
+#    ifdef POINTING_DEVICE_ENABLE
+// From pointing_pipeline(), a click counts like another key press. Motion alone could be the other hand
+// on the ball during a slow tap, it only keeps a lone press from being sampled at all.
+static void adapt_pointer(const report_mouse_t* left_report, const report_mouse_t* right_report) {
+    if (!adapt_held) {
+        return;
+    }
+    if (left_report->buttons | right_report->buttons) {
+        adapt_hold_wanted(timer_read());
+    } else if (left_report->x | left_report->y | right_report->x | right_report->y) {
+        adapt_moved |= adapt_held;
+    }
+}
+#    endif
+
+// From process_record_user(), the release comes after QMK has resolved tap or hold
+static void adapt_release(uint16_t keycode, keyrecord_t* record) {
+    if (record->event.pressed) {
+        return;
+    }
+    int8_t index = adapt_index(keycode);
+    if (index < 0 || !(adapt_held & (1 << index))) {
+        return;     // Not adapted, or pressed before boot
+    }
+    adapt_held &= ~(1 << index);
+    uint16_t held = TIMER_DIFF_16(record->event.time, adapt_press[index]);
+    if (record->tap.count == 0) {
+        if (adapt_first[index] == UINT16_MAX && held < tapping_term_default(keycode)) {
+            if (!(adapt_moved & (1 << index))) {
+                adapt_sample(index, true, held);    // Slow tap the current term turned into a hold
+            }
+            return;     // Held while the trackball moved, a tap or a mod for the pointer, no sample
+        }
+        uint16_t wanted = adapt_first[index];
+#    ifdef PERMISSIVE_HOLD_PER_KEY
+        if (get_permissive_hold(keycode, record)) {
+            wanted = held;      // A roll into another key is resolved by permissive hold, not by the term
+        }
+#    endif
+        adapt_sample(index, false, MIN(held, wanted));
+    } else if (record->tap.count == 1) {
+        adapt_sample(index, true, held);    // Tap-then-hold repeats are left out
+    }
+}
+
+static void adapt_init(void) {
+    if (eeconfig_is_user_datablock_valid()) {
+        eeconfig_read_user_datablock(adapt_hist, 0, sizeof(adapt_hist));
+    }
+    for (uint8_t i = 0; i < ADAPT_KEYS; i++) {
+        adapt_term[i] = adapt_compute(i);
+    }
+}
+
+// Learned term for adapted keys, default_term for the rest
+static uint16_t adapt_get_term(uint16_t keycode, uint16_t default_term) {
+    int8_t index = adapt_index(keycode);
+    return (index < 0) ? default_term : adapt_term[index];
+}
 
-        case O_SPC_L2:
-            return layer_jump_handler(KC_NO, KC_NO, 2, &ri1_timer, BTN_SWAP, record);
+// EEPROM reset (QK_CLEAR_EEPROM), QMK has already zeroed the datablock, terms fall back to the defaults
+void eeconfig_init_user(void) {
+    memset(adapt_hist, 0, sizeof(adapt_hist));
+    adapt_dirty = 0;
+    deadline_cancel(&adapt_token);
+    for (uint8_t i = 0; i < ADAPT_KEYS; i++) {
+        adapt_term[i] = adapt_compute(i);
+    }
+}
+#else
+#define adapt_key_down(keycode, record)
+#define adapt_pointer(left_report, right_report)
+#define adapt_release(keycode, record)
+#define adapt_init()
+#define adapt_get_term(keycode, default_term) (default_term)
+#endif
+
+#ifdef LATENCY_STATS
+// Keypress Latency
+// Time from the matrix event to the end of its processing, when the reports it caused have been sent.
+// event.time is stamped at the matrix scan, so hold decisions (tapping term, combo term) are included.
+// Log bucketed per category and per press/release in RAM, read over VIA with Tools/latency_report.py
+typedef enum latency_categories {
+    LAT_HRM,            // MT_F, MT_G, MT_H, MT_J
+    LAT_LAYER_JUMP,     // layer_jump_handler() keys
+    LAT_TAP_HOLD,       // Other mod/layer taps and dual_keys[]
+    LAT_OTHER,
+    LAT_CATEGORIES
+} lat_category_t;
+
+#define LAT_SUB_BITS    2       // 4 buckets per power of 2
+#define LAT_BUCKETS     37      // 0-3ms exact up to 768-1023ms, last bucket is 1024ms and over
+
+static uint16_t latency_hist[LAT_CATEGORIES * 2][LAT_BUCKETS];  // [category * 2 + released]
+
+static uint8_t latency_bucket(uint16_t ms) {
+    if (ms < (1 << LAT_SUB_BITS)) {
+        return ms;
+    }
+    if (ms >= 1024) {
+        return LAT_BUCKETS - 1;
+    }
+    uint8_t msb = 31 - __builtin_clz(ms);
+    return ((msb - LAT_SUB_BITS + 1) << LAT_SUB_BITS) | ((ms >> (msb - LAT_SUB_BITS)) & ((1 << LAT_SUB_BITS) - 1));
+}
+
+static uint8_t latency_category(uint16_t keycode) {
+    switch (keycode) {
+        case MT_F:
+        case MT_G:
+        case MT_H:
+        case MT_J:
+            return LAT_HRM;
+    }
+    uint8_t kind = dual_key_kind(keycode);
+    if (kind == DK_LAYER || kind == DK_LAYER_INV) {
+        return LAT_LAYER_JUMP;
+    }
+    if (kind != DK_NONE) {
+        return LAT_TAP_HOLD;
+    }
+    if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+        return LAT_TAP_HOLD;
+    }
+    return LAT_OTHER;
+}
 
-        case I_SPC_L1:
-            return layer_jump_handler(KC_CAPS, KC_SPC, 1, &le1_timer, !BTN_SWAP, record);
+static void latency_record(uint16_t keycode, keyrecord_t* record) {
+    uint16_t* bucket = &latency_hist[latency_category(keycode) * 2 + !record->event.pressed]
+                                    [latency_bucket(timer_elapsed(record->event.time))];
+    if (*bucket < UINT16_MAX) {
+        (*bucket)++;
+    }
+}
 
-        case I_SPC_L2:
-            return layer_jump_handler(KC_NO, KC_NO, 2, &ri1_timer, !BTN_SWAP, record);
-        // Group for mouse buttons with tap-hold behavior
-        // _MB* are toggled by RGB_MS_ACTIVE to change to mouse buttons on mouse move
-        case R_MB1:
-            return tap_hold_handler(KC_Y, KC_MS_BTN1, NULL, !RGB_MS_ACTIVE, true, record);
+// Keys QMK goes on to process land here, once their action has run
+void post_process_record_user(uint16_t keycode, keyrecord_t* record) {
+    latency_record(keycode, record);
+}
 
-        case R_MB2:
-            return tap_hold_handler(KC_U, KC_MS_BTN2, NULL, !RGB_MS_ACTIVE, true, record);
+#ifdef VIA_ENABLE
+// VIA custom channel, see Tools/latency_report.py
+#define LATENCY_CHANNEL 0x4C    // 'L'
 
-        case L_MB1:
-            return tap_hold_handler(KC_T, KC_MS_BTN1, NULL, !RGB_MS_ACTIVE, true, record);
+enum latency_values {
+    LAT_VALUE_INFO,     // Get: categories, buckets, sub-bucket bits
+    LAT_VALUE_HIST,     // Get: data[3] = histogram, data[4] = first bucket, counts follow as uint16 LE
+    LAT_VALUE_RESET     // Set: clear all histograms
+};
 
-        case L_MB2:
-            return tap_hold_handler(KC_R, KC_MS_BTN2, NULL, !RGB_MS_ACTIVE, true, record);
+static void latency_via_command(uint8_t* data, uint8_t length) {
+    uint8_t* command_id = &data[0];
+    uint8_t* value_id   = &data[2];
+
+    if (*command_id == id_custom_get_value && *value_id == LAT_VALUE_INFO) {
+        data[3] = LAT_CATEGORIES;
+        data[4] = LAT_BUCKETS;
+        data[5] = LAT_SUB_BITS;
+    } else if (*command_id == id_custom_get_value && *value_id == LAT_VALUE_HIST && data[3] < LAT_CATEGORIES * 2) {
+        for (uint8_t i = 5, bucket = data[4]; i + 1 < length; i += 2, bucket++) {
+            uint16_t count = (bucket < LAT_BUCKETS) ? latency_hist[data[3]][bucket] : 0;
+            data[i]     = count & 0xFF;
+            data[i + 1] = count >> 8;
+        }
+    } else if (*command_id == id_custom_set_value && *value_id == LAT_VALUE_RESET) {
+        memset(latency_hist, 0, sizeof(latency_hist));
+    } else {
+        *command_id = id_unhandled;
+    }
+}
+#endif
+#else
+#define latency_record(keycode, record)
+#endif
 
-        case R_SHIFT:
-            return tap_hold_handler(KC_K, KC_LSFT, NULL, !RGB_MS_ACTIVE, true, record);
+#ifdef VIA_ENABLE
+// Custom VIA channels, anything else is left unhandled
+void via_custom_value_command_user(uint8_t* data, uint8_t length) {
+    switch (data[1]) {  // Channel
+#ifdef LATENCY_STATS
+        case LATENCY_CHANNEL:
+            latency_via_command(data, length);
+            return;
+#endif
+#ifdef STAGE_PROFILE
+        case STAGE_CHANNEL:
+            stage_via_command(data, length);
+            return;
+#endif
+    }
+    data[0] = id_unhandled;
+}
+#endif
 
-        case L_SHIFT:
-            return tap_hold_handler(KC_D, KC_LSFT, NULL, !RGB_MS_ACTIVE, true, record);
+// Every key press in matrix order, as it comes off the matrix
+// pre_process_record_user() runs this before combo_process(), so keys a chord holds back are seen here
+// once, before they are held back. Replays from the chord buffer skip it.
+static void key_press_observe(uint16_t keycode, keyrecord_t* record) {
+    if (!record->event.pressed || !IS_KEYEVENT(record->event)) {
+        return;
+    }
+    if (!dual_key_is_layer_jump(keycode)) {
+        layer_jump_interrupt(record);
+    }
+    adapt_key_down(keycode, record);
+}
 
-        case ML_MB1:
-            return tap_hold_handler(KC_MS_BTN1, KC_MS_BTN1, NULL, !ATML_ACTIVE, true, record);
+// Runs before the key is looked up in the keymap, so a layer committed here already applies to it
+bool pre_process_record_user(uint16_t keycode, keyrecord_t* record) {
+    key_press_observe(keycode, record);
+    return combo_process(record);
+}
 
-        case ML_MB2:
-            return tap_hold_handler(KC_MS_BTN2, KC_MS_BTN2, NULL, !ATML_ACTIVE, true, record);
+bool process_record_user(
+    uint16_t        keycode,
+    keyrecord_t*    record) {
 
-        case ESC_GRV:
-            return tap_hold_handler(KC_ESC, KC_GRV, &ri1_timer, NULL, NULL, record);
+    adapt_release(keycode, record);
+    if (process_record_keymap(keycode, record)) {
+        return true;    // Measured in post_process_record_user()
+    }
+    // QMK skips post processing for keys the keymap handled itself
+    latency_record(keycode, record);
+    return false;
+}
 
-        case LTB_BK: // LEFT TAB & BACKWARD
-            return tap_hold_handler(RCS(KC_TAB), KC_WWW_BACK, &rd1_timer, NULL, true, record);
+// Combos Start
+// Combos are matched here instead of by QMK's combo engine (COMBO_ENABLE = no in rules.mk).
+// A combo is a set of matrix positions, so everything a key press needs is in tables built at compile time
+// from COMBO_LIST below: the combos each position is in, and the combos each layer has. The work per key
+// event depends on how many combos that one key is in, not on how many combos there are.
+
+// Matrix positions named like the LAYOUT() arguments: L/R half, row, column counted from the outer edge.
+// Bit n of a key_set_t is row * MATRIX_COLS + col, the right half rows run mirrored in the matrix.
+enum key_positions {
+    L00 = 0 * MATRIX_COLS, L01, L02, L03, L04, L05,
+    L10 = 1 * MATRIX_COLS, L11, L12, L13, L14, L15,
+    L20 = 2 * MATRIX_COLS, L21, L22, L23, L24, L25,
+    L30 = 3 * MATRIX_COLS, L31, L32, L33, L34, L35,
+    L41 = 4 * MATRIX_COLS + 1, L42, L43, L44, L45,
+    R05 = 5 * MATRIX_COLS, R04, R03, R02, R01, R00,
+    R15 = 6 * MATRIX_COLS, R14, R13, R12, R11, R10,
+    R25 = 7 * MATRIX_COLS, R24, R23, R22, R21, R20,
+    R35 = 8 * MATRIX_COLS, R34, R33, R32, R31, R30,
+    R44 = 9 * MATRIX_COLS + 1, R43, R42, R41, R40
+};
 
-        case RTB_FW: // RIGHT TAB & FORWARD
-            return tap_hold_handler(RCTL(KC_TAB), KC_WWW_FORWARD, &rd1_timer, NULL, true, record);
+typedef uint64_t key_set_t;     // bit n = matrix position n
+typedef uint32_t combo_set_t;   // bit n = combo n
+#define KEY_BIT(pos)        ((key_set_t)1 << (pos))
+_Static_assert(MATRIX_ROWS * MATRIX_COLS <= 64, "key_set_t holds one bit per matrix position");
+
+// Combo definitions, the one place combos are listed
+// X(name, output, layers, keys, arg): keys are the positions to press together, layers the ones the combo
+// works on, checked against the highest active layer. Adding a combo is one line here.
+// arg is passed through untouched, for the tables below that are built per position or per layer.
+#define COMBO_LIST(X, arg) \
+    X(CL_PRN,   KC_LPRN,    LAYER_BIT(0),                   KEY_BIT(L13) | KEY_BIT(L12), arg)   /* E + W            */ \
+    X(CR_PRN,   KC_RPRN,    LAYER_BIT(0),                   KEY_BIT(R12) | KEY_BIT(R13), arg)   /* I + O            */ \
+    X(CL_CBR,   KC_LCBR,    LAYER_BIT(0),                   KEY_BIT(L23) | KEY_BIT(L22), arg)   /* D + S            */ \
+    X(CR_CBR,   KC_RCBR,    LAYER_BIT(0),                   KEY_BIT(R23) | KEY_BIT(R22), arg)   /* L + K            */ \
+    X(CL_BRC,   KC_LBRC,    LAYER_BIT(0),                   KEY_BIT(L33) | KEY_BIT(L32), arg)   /* C + X            */ \
+    X(CR_BRC,   KC_RBRC,    LAYER_BIT(0),                   KEY_BIT(R33) | KEY_BIT(R32), arg)   /* . + ,            */ \
+    X(C_DEL,    KC_DEL,     LAYER_BIT(0),                   KEY_BIT(L24) | KEY_BIT(L23), arg)   /* F + D            */ \
+    X(C_BSP,    KC_BSPC,    LAYER_BIT(0),                   KEY_BIT(R22) | KEY_BIT(R21), arg)   /* K + J            */ \
+    X(CL_MMB,   KC_MS_BTN3, LAYER_BIT(0) | LAYER_BIT(3),    KEY_BIT(L15) | KEY_BIT(L14), arg)   /* MB1 + MB2 left   */ \
+    X(CR_MMB,   KC_MS_BTN3, LAYER_BIT(0) | LAYER_BIT(3),    KEY_BIT(R10) | KEY_BIT(R11), arg)   /* MB1 + MB2 right  */ \
+    X(C_F5,     KC_F5,      LAYER_BIT(2) | LAYER_BIT(3),    KEY_BIT(R00) | KEY_BIT(R01), arg)   /* Left + Right Tab */ \
+    X(C_CAP1,   KC_CAPS,    LAYER_BIT(0),                   KEY_BIT(L10) | KEY_BIT(L11), arg)   /* Tab + Q          */ \
+    X(C_ATML,   ML_AUTO,    LAYER_BIT(0),                   KEY_BIT(L05) | KEY_BIT(R00), arg)   /* 5 + 6            */ \
+    X(C_EQL,    KC_EQL,     LAYER_BIT(0),                   KEY_BIT(R04) | KEY_BIT(R05), arg)   /* 0 + Backspace    */ \
+    X(C_SWP,    B_SWAP,     LAYER_BIT(0),                   KEY_BIT(L00) | KEY_BIT(L01), arg)   /* Esc + 1          */ \
+    X(C_CDEL,   C(KC_DEL),  LAYER_BIT(0),                   KEY_BIT(L24) | KEY_BIT(L25), arg)   /* F + G            */ \
+    X(C_CBSP,   C(KC_BSPC), LAYER_BIT(0),                   KEY_BIT(R20) | KEY_BIT(R21), arg)   /* H + J            */ \
+    X(C_PIN,    SE_PW,      LAYER_BIT(0),                   KEY_BIT(L35) | KEY_BIT(L45), arg)   /* B + L1 / Play    */ \
+    X(C_LARR,   CC_LARR,    LAYER_BIT(0),                   KEY_BIT(L33) | KEY_BIT(L34), arg)   /* C + V            */ \
+    X(C_RARR,   CC_RARR,    LAYER_BIT(0),                   KEY_BIT(R31) | KEY_BIT(R32), arg)   /* M + ,            */
+
+#define COMBO_ENUM(name, output, layers, keys, arg)     name,
+#define COMBO_KEYS(name, output, layers, keys, arg)     [name] = (keys),
+#define COMBO_OUTPUT(name, output, layers, keys, arg)   [name] = (output),
+#define COMBO_UNION(name, output, layers, keys, arg)    | (keys)
+#define COMBO_AT(name, output, layers, keys, pos)       | ((combo_set_t)(((keys) >> (pos)) & 1) << name)
+#define COMBO_ON(name, output, layers, keys, layer)     | ((combo_set_t)(((layers) >> (layer)) & 1) << name)
 
-        case CT_UN: // CLOSE TAB & UNDO CLOSE TAB
-            return tap_hold_handler(RCTL(KC_W), RCS(KC_T), &rd1_timer, NULL, true, record);
+enum combos {
+    COMBO_LIST(COMBO_ENUM, 0)
+    COMBO_COUNT
+};
+_Static_assert(COMBO_COUNT <= 32, "combo_set_t holds one bit per combo");
+
+static const key_set_t PROGMEM combo_keys[COMBO_COUNT]    = {COMBO_LIST(COMBO_KEYS, 0)};
+static const uint16_t  PROGMEM combo_outputs[COMBO_COUNT] = {COMBO_LIST(COMBO_OUTPUT, 0)};
+
+#define COMBO_KEYS_ALL      (0 COMBO_LIST(COMBO_UNION, 0))
+#define COMBOS_AT(pos)      (0 COMBO_LIST(COMBO_AT, pos))
+#define COMBOS_AT_ROW(row)  COMBOS_AT(row * MATRIX_COLS + 0), COMBOS_AT(row * MATRIX_COLS + 1), COMBOS_AT(row * MATRIX_COLS + 2), \
+                            COMBOS_AT(row * MATRIX_COLS + 3), COMBOS_AT(row * MATRIX_COLS + 4), COMBOS_AT(row * MATRIX_COLS + 5)
+#define COMBOS_ON(layer)    (0 COMBO_LIST(COMBO_ON, layer))
+
+// Combos each matrix position is in
+_Static_assert(MATRIX_ROWS == 10 && MATRIX_COLS == 6, "combos_at[] is written out for the Lily58 matrix");
+static const combo_set_t PROGMEM combos_at[MATRIX_ROWS * MATRIX_COLS] = {
+    COMBOS_AT_ROW(0), COMBOS_AT_ROW(1), COMBOS_AT_ROW(2), COMBOS_AT_ROW(3), COMBOS_AT_ROW(4),
+    COMBOS_AT_ROW(5), COMBOS_AT_ROW(6), COMBOS_AT_ROW(7), COMBOS_AT_ROW(8), COMBOS_AT_ROW(9)
+};
 
-        case CW_LW: // LAST WINDOW & CYCLE WINDOWS
-            return tap_hold_handler(A(KC_TAB), A(KC_ESC), &rd1_timer, NULL, true, record);
+// Combos each layer has, by the highest active layer
+static const combo_set_t PROGMEM combos_on[] = {COMBOS_ON(0), COMBOS_ON(1), COMBOS_ON(2), COMBOS_ON(3), COMBOS_ON(4)};
+_Static_assert(ARRAY_SIZE(combos_on) == DYNAMIC_KEYMAP_LAYER_COUNT, "combos_on[] needs one entry per layer");
 
-        case NX_PR: // NEXT & PREVIOUS
-            return tap_hold_handler(KC_MNXT, KC_MPRV, &ld1_timer, NULL, true, record);
+// A chord never holds more keys than there are combo keys
+#define COMBO_BUFFER_LENGTH __builtin_popcountll(COMBO_KEYS_ALL)
 
-        case UN_RE: // UNDO & REDO
-            return tap_hold_handler(C(KC_Z), C(KC_Y), &ld1_timer, NULL, true, record);
+static key_set_t combo_keys_read(uint8_t index) {
+    key_set_t keys;
+    memcpy_P(&keys, &combo_keys[index], sizeof(keys));
+    return keys;
+}
 
-        case CO_PA: // COPY & PASTE
-            return tap_hold_handler(C(KC_C), C(KC_V), &ld1_timer, NULL, true, record);
+// Combos that can fire right now
+static combo_set_t combos_live(void) {
+    uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+    if (!COMBO_ON || layer >= ARRAY_SIZE(combos_on)) {
+        return 0;
+    }
+    return pgm_read_dword(&combos_on[layer]);
+}
 
-        case VU_VD: // VOLUME UP & VOLUME DOWN
-            return tap_hold_handler(KC_VOLU, KC_VOLD, &rd1_timer, NULL, true, record);
+#ifdef COMBO_TERM_PER_COMBO
+static uint16_t combo_term_get(uint8_t index);
+static void     combo_skew_sample(uint8_t index, uint16_t skew);
+#else
+#define combo_term_get(index) COMBO_TERM
+#define combo_skew_sample(index, skew)
+#endif
 
-        case CT_TW: // CYCLE TASKBAR & TAB CYCLE WINDOWS
-            return tap_hold_handler(G(KC_T), LCA(KC_TAB), &rd1_timer, NULL, true, record);
+// The chord in progress: key presses held back while they could still be a combo
+static keyrecord_t  combo_buffer[COMBO_BUFFER_LENGTH];
+static uint8_t      combo_buffered = 0;
+static key_set_t    combo_chord    = 0;     // Positions in combo_buffer[]
+static combo_set_t  combo_cands    = 0;     // Live combos that contain every key of the chord
+// Fired combos
+static combo_set_t  combo_held     = 0;     // Combos whose output is pressed
+static key_set_t    combo_eaten    = 0;     // Their keys still down, the releases are dropped
+
+// Sends a combo's output as a COMBO_EVENT, like QMK's combo engine did. Custom keycodes go to
+// process_record_user(), what it leaves to QMK is registered here.
+static void combo_output(uint8_t index, uint16_t time, bool pressed) {
+    uint16_t    keycode = pgm_read_word(&combo_outputs[index]);
+    keyrecord_t record  = {
+        .event = {.key = {.col = KEYLOC_COMBO, .row = KEYLOC_COMBO}, .time = time, .type = COMBO_EVENT, .pressed = pressed},
+    };
+    if (process_record_user(keycode, &record) && keycode <= QK_MODS_MAX) {
+        pressed ? register_code16(keycode) : unregister_code16(keycode);
+    }
+}
 
-        case DE_CU: // DELETE & CUT
-            return tap_hold_handler(KC_DEL, C(KC_X), &rd1_timer, NULL, true, record);
+// The chord wasn't a combo, its keys go on to the tapping engine in the order they were pressed
+static void combo_flush(void) {
+    deadline_cancel(&combo_token);
+    uint8_t count  = combo_buffered;
+    combo_buffered = 0;
+    combo_chord    = 0;
+    combo_cands    = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        action_tapping_process(combo_buffer[i]);
+    }
+}
 
-        case CW_FS: // CLOSE WINDOW & FULLSCREEN
-            return tap_hold_handler(A(KC_F4), KC_F11, &rd1_timer, NULL, true, record);
+static void combo_fire(uint8_t index) {
+    deadline_cancel(&combo_token);
+    uint16_t time = combo_buffer[combo_buffered - 1].event.time;
+    combo_skew_sample(index, TIMER_DIFF_16(time, combo_buffer[0].event.time));
+    combo_held |= (combo_set_t)1 << index;
+    combo_eaten |= combo_chord;
+    combo_buffered = 0;
+    combo_chord    = 0;
+    combo_cands    = 0;
+    combo_output(index, time, true);
+}
 
-        case DL_DR: // VIRTUAL DESKOP LEFT & VIRTUAL DESKTOP RIGHT
-            return tap_hold_handler(G(C(KC_LEFT)), G(C(KC_RIGHT)), &rd1_timer, NULL, true, record);
+// Nothing completed the chord within the longest term of its combos
+static uint32_t combo_timeout_callback(uint32_t trigger_time, void* cb_arg) {
+    combo_token = INVALID_DEFERRED_TOKEN;
+    combo_flush();
+    return 0;
+}
 
-        case PU_PD: //  Page Up & Page Down
-            return tap_hold_handler(KC_PGUP, KC_PGDN, &rd1_timer, NULL, true, record);
+// Candidates whose term still covers a key pressed skew ms after the first
+static combo_set_t combo_within(combo_set_t cands, uint16_t skew) {
+    for (combo_set_t c = cands; c; c &= c - 1) {
+        uint8_t i = __builtin_ctz(c);
+        if (skew > combo_term_get(i)) {
+            cands &= ~((combo_set_t)1 << i);
+        }
+    }
+    return cands;
+}
 
-        case HM_EN: // Home & End
-            return tap_hold_handler(KC_HOME, KC_END, &rd1_timer, NULL, true, record);
+// From pre_process_record_user(), false = the event is held back or used up here.
+// A key in a live combo starts a chord and waits for the longest term of its combos. Each further key
+// narrows the candidates to the combos holding it too. A combo fires as soon as all of its keys are down,
+// so a combo whose keys all belong to a bigger one shadows it. A key in none of the candidates, a release
+// or the term running out ends the chord, its keys are replayed and the new event goes on after them.
+// Replayed keys go straight to action_tapping_process() and don't pass pre_process_record_user() again.
+static bool combo_process(keyrecord_t* record) {
+    if (!IS_KEYEVENT(record->event)) {
+        return true;
+    }
+    uint8_t   pos = record->event.key.row * MATRIX_COLS + record->event.key.col;
+    key_set_t key = KEY_BIT(pos);
 
-#ifdef CONSOLE_ENABLE
-        case MS_DEBUG:
-            if (record->event.pressed) {
-                debug_enable = !debug_enable;  // Toggle debug output
-                if (debug_enable) {
-                    uprintf("Debug Enabled\n");
-                } else {
-                    uprintf("Debug Disabled\n");
-                }
-            }
-            return false;
-#endif
-        // On shift, backspace turns to KC_KEY
-        case BSPC_MINS:
-            if (record->event.pressed) {
-                if (get_mods() & MOD_MASK_SHIFT) {
-                    register_code(KC_MINS);
-                } else {
-                ri1_timer = timer_read();
-                }
-            } else {
-                // Shift NOT held AND tap duration less than TAPPING_TERM to send Backspace
-                if (!(get_mods() & MOD_MASK_SHIFT) && (timer_elapsed(ri1_timer) < TAPPING_TERM)) {
-                    tap_code(KC_BSPC);
-                } else {
-                    if (get_mods() & MOD_MASK_SHIFT) {
-                        unregister_code(KC_MINS);
-                    } else {
-                        tap_code(KC_MINS);
-                    }
-                }
-            }
-            return false;
+    if (!record->event.pressed) {
+        if (combo_chord & key) {
+            combo_flush();      // Released before the chord was complete
+            return true;
+        }
+        if (!(combo_eaten & key)) {
+            return true;
+        }
+        // QMK's behaviour: the first key let go releases the combo, the others are dropped
+        combo_eaten &= ~key;
+        for (combo_set_t c = combo_held & pgm_read_dword(&combos_at[pos]); c; c &= c - 1) {
+            uint8_t i = __builtin_ctz(c);
+            combo_held &= ~((combo_set_t)1 << i);
+            combo_output(i, record->event.time, false);
+        }
+        return false;
+    }
 
-        // Toggle Button Swap for MB* keys
-        case B_SWAP:
-            if (record->event.pressed) {
-                BTN_SWAP = !BTN_SWAP;
-                layer_jump_timeout();
-                if (is_keyboard_master()) {
-                    uint8_t msg[2] = {2, BTN_SWAP};
-                    transaction_rpc_send(USER_SYNC, sizeof(msg), msg);
+    combo_set_t cands = pgm_read_dword(&combos_at[pos]) & combos_live();
+    if (combo_buffered) {
+        uint16_t skew = TIMER_DIFF_16(record->event.time, combo_buffer[0].event.time);
+        cands         = combo_within(combo_cands & cands, skew);
+        if (cands) {
+            combo_buffer[combo_buffered++] = *record;
+            combo_chord |= key;
+            combo_cands = cands;
+            for (; cands; cands &= cands - 1) {
+                uint8_t i = __builtin_ctz(cands);
+                if (combo_keys_read(i) == combo_chord) {
+                    combo_fire(i);
+                    break;
                 }
-                set_trackball_rgb_for_slave(0, 2);
-            }
-            return false;
-        // Toggles Auto Mouse Layer
-        case ML_AUTO:
-            if (record->event.pressed) {
-                ATML = !ATML;
-            }
-            layer_jump_timeout();
-            set_trackball_rgb_for_slave(3, 2);
-            return false;
-        // Incrementer
-        case FX_SLV_M: // Reduce growth factor
-            if (record->event.pressed) {
-                GROWTH_FACTOR -= 1;
-            }
-            return false;
-
-        case FX_SLV_P: // Increase growth factor
-            if (record->event.pressed) {
-                GROWTH_FACTOR += 1;
             }
             return false;
+        }
+        combo_flush();
+        cands = pgm_read_dword(&combos_at[pos]) & combos_live();     // This key may start a chord of its own
+    }
+    if (!cands) {
+        return true;
+    }
 
-        case SE_PW:
-            if (record->event.pressed) {
-                send_string(" ");
-                wait_ms(200);
-                send_string("2326");
-
-            /* Requires SEND_STRING_ENABLE = yes in rules.mk */
-            }
-            return false;
+    uint16_t term = 0;
+    for (combo_set_t c = cands; c; c &= c - 1) {
+        term = MAX(term, combo_term_get(__builtin_ctz(c)));
     }
-    return true;
+    combo_buffer[0] = *record;
+    combo_buffered  = 1;
+    combo_chord     = key;
+    combo_cands     = cands;
+    deadline_set(&combo_token, term, combo_timeout_callback);
+    return false;
 }
 
-// Combos Start
-enum combos {
-    CL_PRN,
-    CR_PRN,
-    CL_CBR,
-    CR_CBR,
-    CL_BRC,
-    CR_BRC,
-    C_DEL,
-    C_BSP,
-    CL_MMB,
-    CR_MMB,
-    CM_MMB,
-    C_F5,
-    C_CAP1,
-    C_ATML,
-    C_EQL,
-    C_SWP,
-    C_CDEL,
-    C_CBSP,
-    C_PIN,
-    C_LARR,
-    C_RARR,
-};
-
-const uint16_t PROGMEM l_prn[] = {KC_E, KC_W, COMBO_END};
-const uint16_t PROGMEM r_prn[] = {KC_I, KC_O, COMBO_END};
-const uint16_t PROGMEM l_cbr[] = {L_SHIFT, KC_S, COMBO_END};
-const uint16_t PROGMEM r_cbr[] = {KC_L, R_SHIFT, COMBO_END};
-const uint16_t PROGMEM l_brc[] = {KC_C, KC_X, COMBO_END};
-const uint16_t PROGMEM r_brc[] = {KC_DOT, KC_COMM, COMBO_END};
-const uint16_t PROGMEM l_del[] = {MT_F, L_SHIFT, COMBO_END};
-const uint16_t PROGMEM r_bsp[] = {R_SHIFT, MT_J, COMBO_END};
-const uint16_t PROGMEM l_mmb[] = {L_MB1, L_MB2, COMBO_END};
-const uint16_t PROGMEM r_mmb[] = {R_MB1, R_MB2, COMBO_END};
-const uint16_t PROGMEM m_mmb[] = {ML_MB1, ML_MB2, COMBO_END};
-const uint16_t PROGMEM c_f5[] = {LTB_BK, RTB_FW, COMBO_END};
-const uint16_t PROGMEM c_cap1[] = {KC_TAB, KC_Q, COMBO_END};
-const uint16_t PROGMEM c_mm[] = {KC_5, KC_6, COMBO_END};
-const uint16_t PROGMEM c_equ[] = {KC_0, BSPC_MINS, COMBO_END};
-const uint16_t PROGMEM c_swp[] = {ESC_GRV, KC_1, COMBO_END};
-const uint16_t PROGMEM c_cdel[] = {MT_F, MT_G, COMBO_END};
-const uint16_t PROGMEM c_cbsp[] = {MT_H, MT_J, COMBO_END};
-const uint16_t PROGMEM c_pin[] = {KC_B, LT(1, KC_MPLY), COMBO_END};
-const uint16_t PROGMEM c_larr[] = {KC_C, KC_V, COMBO_END};
-const uint16_t PROGMEM c_rarr[] = {KC_M, KC_COMM, COMBO_END};
-
-
-combo_t key_combos[COMBO_COUNT] = {
-    [CL_PRN] = COMBO(l_prn, KC_LPRN),
-    [CR_PRN] = COMBO(r_prn, KC_RPRN),
-    [CL_CBR] = COMBO(l_cbr, KC_LCBR),
-    [CR_CBR] = COMBO(r_cbr, KC_RCBR),
-    [CL_BRC] = COMBO(l_brc, KC_LBRC),
-    [CR_BRC] = COMBO(r_brc, KC_RBRC),
-    [C_DEL] = COMBO(l_del, KC_DEL),
-    [C_BSP] = COMBO(r_bsp, KC_BSPC),
-    [CL_MMB] = COMBO(l_mmb, KC_MS_BTN3),
-    [CR_MMB] = COMBO(r_mmb, KC_MS_BTN3), // 10
-    [CM_MMB] = COMBO(m_mmb, KC_MS_BTN3),
-    [C_F5] = COMBO(c_f5, KC_F5),
-    [C_CAP1] = COMBO(c_cap1, KC_CAPS),
-    [C_ATML] = COMBO(c_mm, ML_AUTO),
-    [C_EQL] = COMBO(c_equ, KC_EQL),
-    [C_SWP] = COMBO(c_swp, B_SWAP),
-    [C_CDEL] = COMBO(c_cdel, C(KC_DEL)),
-    [C_CBSP] = COMBO(c_cbsp, C(KC_BSPC)),
-    [C_PIN] = COMBO(c_pin, SE_PW),
-    [C_LARR] = COMBO(c_larr, CC_LARR),
-    [C_RARR] = COMBO(c_rarr, CC_RARR),
-};
-
 #ifdef COMBO_TERM_PER_COMBO
-uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) {
-    // decide by combo->keycode
-    switch (combo->keycode) {
-        case KC_X:
-            return 50;
+// Per-combo term, learned from how far apart the keys of each chord go down
+// The skew is the time from the first key of a chord to the last, sampled when the combo fires. Rolls
+// that come out as normal keys, released early or slower than the current term, don't count.
+// Skews go in a 2ms bucket histogram per combo, the term is its p99 plus COMBO_SKEW_MARGIN, clamped to
+// [COMBO_TERM_MIN, COMBO_TERM]. Combos hit crisply hold their keys back a few ms instead of COMBO_TERM.
+// Kept in RAM, every boot starts from COMBO_TERM.
+#define COMBO_SKEW_BUCKET_MS    2
+#define COMBO_SKEW_BUCKETS      (COMBO_TERM / COMBO_SKEW_BUCKET_MS + 1)
+#define COMBO_SKEW_MARGIN       3       // ms on top of p99
+#define COMBO_SKEW_MIN_SAMPLES  16      // Chords needed before COMBO_TERM is left
+#define COMBO_TERM_MIN          6
+
+static uint8_t  combo_skew[COMBO_COUNT][COMBO_SKEW_BUCKETS];
+static uint8_t  combo_term[COMBO_COUNT];            // Learned term, 0 until enough chords
+
+static void combo_skew_sample(uint8_t index, uint16_t skew) {
+    uint8_t* hist = combo_skew[index];
+    uint8_t* bucket = &hist[skew / COMBO_SKEW_BUCKET_MS];
+    if (*bucket == UINT8_MAX) {
+        for (uint8_t b = 0; b < COMBO_SKEW_BUCKETS; b++) {
+            hist[b] >>= 1;      // Ages the histogram, recent chords outweigh old ones
+        }
     }
+    (*bucket)++;
 
-    // or with combo index, i.e. its name from enum.
-    switch (combo_index) {
-        case COMBO_NAME_HERE:
-            return 9001;
+    uint16_t total = 0;
+    for (uint8_t b = 0; b < COMBO_SKEW_BUCKETS; b++) {
+        total += hist[b];
     }
-
-    // And if you're feeling adventurous, you can even decide by the keys in the chord,
-    // i.e. the exact array of keys you defined for the combo.
-    // This can be useful if your combos have a common key and you want to apply the
-    // same combo term for all of them.
-    if (combo->keys[0] == KC_ENT) { // if first key in the array is Enter
-        return 150;
+    if (total < COMBO_SKEW_MIN_SAMPLES) {
+        return;
     }
+    // Upper edge of the bucket holding the 99th percentile
+    uint16_t target = (total * 99 + 99) / 100;
+    uint16_t seen   = 0;
+    uint8_t  b      = 0;
+    while ((seen += hist[b]) < target) {
+        b++;
+    }
+    uint16_t term = (b + 1) * COMBO_SKEW_BUCKET_MS - 1 + COMBO_SKEW_MARGIN;
+    combo_term[index] = MAX(COMBO_TERM_MIN, MIN(term, COMBO_TERM));
+}
 
-    return COMBO_TERM;
+static uint16_t combo_term_get(uint8_t index) {
+    return combo_term[index] ? combo_term[index] : COMBO_TERM;
 }
 #endif
 
 // Combos End
 // Set custom Tapping Term
-uint16_t get_tapping_term(
-    uint16_t        keycode,
-    keyrecord_t*    record) {
-
+// Defaults per key, keys in adapt_keys[] start here and move to their learned term
+static uint16_t tapping_term_default(uint16_t keycode) {
     switch (keycode) {
         case LT(2, KC_SPC):
         case MT_F:
@@ -571,10 +1804,54 @@ uint16_t get_tapping_term(
         default:
             return TAPPING_TERM;
     }
+}
+
+uint16_t get_tapping_term(
+    uint16_t        keycode,
+    keyrecord_t*    record) {
+
+    return adapt_get_term(keycode, tapping_term_default(keycode));
     // Requires #define TAPPING_TERM in config.h
     // #define TAPPING_TERM_PER_KEY , to set tapping term per key if needed
 }
 
+// Speculative home row mods, Ctrl/Shift go down with the key so mod-clicks and shortcuts don't wait for the
+// 250ms term. QMK takes the mod back before sending the tap if the key resolves as a tap.
+// Alt and GUI mod-taps are left out, a retracted Alt or GUI tap opens menus on the host.
+// Requires #define SPECULATIVE_HOLD in config.h
+bool get_speculative_hold(
+    uint16_t        keycode,
+    keyrecord_t*    record) {
+
+    switch (keycode) {
+        case MT_F:
+        case MT_G:
+        case MT_H:
+        case MT_J:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// A key pressed and released inside a held home row mod makes it a hold right then, instead of at the term
+// Only the home row mods, global PERMISSIVE_HOLD interferes with the other custom tapping terms
+// Requires #define PERMISSIVE_HOLD_PER_KEY in config.h, replay typing through Tools/hrm_sim.py to check for roll misfires
+bool get_permissive_hold(
+    uint16_t        keycode,
+    keyrecord_t*    record) {
+
+    switch (keycode) {
+        case MT_F:
+        case MT_G:
+        case MT_H:
+        case MT_J:
+            return true;
+        default:
+            return false;
+    }
+}
+
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 [0] = LAYOUT(
 /* QWERTY
@@ -705,9 +1982,9 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 */        B_SWAP,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,                                              KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,
 /* |            |            |            |            |            |            |       MOMENTUM                       |            |            |            |            |            |            |
    |------------+------------+------------+------------+------------+------------|       MIN_SCALE                      |------------+------------+------------+------------+------------+------------|
-   |   LShift   |            |            |            |            |            |       MAX_SCALE                      |Incrementer |Incrementer |            |            |            |            |
+   |   LShift   |            |            |            |            |            |       MAX_SCALE                      |Incrementer |Incrementer |            |            |            |   RShift   |
                                                                                                                              -0.5         +0.5
-*/       KC_TRNS,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,                                              KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,
+*/       KC_TRNS,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,                                              KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_NO,       KC_RSFT,
 /* |            |            |            |            |            |            |-------------.          ,-------------|            |            |            |            |            |            |
    |------------+------------+------------+------------+------------+------------|GROWTH_FACTOR|          |GROWTH_FACTOR|------------+------------+------------+------------+------------+------------|
          LCtrl               |            |            |            |                                                    Incrementer  Incrementer
@@ -723,72 +2000,91 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 */)
 };
 
-#ifdef CONSOLE_ENABLE
-// Debugging Mouse Reports
-// Pass the mouse reports to this function to print debug info if debug is enabled
-void debug_mouse_reports(report_mouse_t left_report, report_mouse_t right_report) {
-        uint16_t t = timer_read();
-        (void)t;  // Tell compiler t is intentionally unused (suppresses warning)
-        if (left_report.x || left_report.y || left_report.h || left_report.v || left_report.buttons) {
-            uprintf("[%lu] LEFT: x=%d y=%d h=%d v=%d buttons=0x%02X\n",
-                    (unsigned long)t, left_report.x, left_report.y,
-                    left_report.h, left_report.v, left_report.buttons);
-        }
-        if (right_report.x || right_report.y || right_report.h || right_report.v || right_report.buttons) {
-            uprintf("[%lu] RIGHT: x=%d y=%d h=%d v=%d buttons=0x%02X\n",
-                    (unsigned long)t, right_report.x, right_report.y,
-                    right_report.h, right_report.v, right_report.buttons);
-        }
-}
-#endif
-
 // ------------------------------- //
 //   RGB Layer Synchronization RPC //
 // ------------------------------- //
 
+// Trackball colours, indexed by [layer][BTN_SWAP] as RGBW
+// Layers 0 and 4 flip between blue and white to show that keys are swapped
+// Hot Pink (255, 105, 180), Orange (255, 165, 0), Indigo (75, 0, 130), Violet (138, 43, 226), Purple (128, 0, 128)
+#define TRACKBALL_COLORS 7
+static const uint8_t PROGMEM trackball_colors[TRACKBALL_COLORS][2][4] = {
+    [0] = {{0, 0, 255, 0},      {255, 255, 255, 0}},    // Base layer: Blue, White (swapped)
+    [1] = {{192, 0, 64, 0},     {192, 0, 64, 0}},       // Red
+    [2] = {{0, 192, 128, 0},    {0, 192, 128, 0}},      // Green
+    [3] = {{153, 113, 0, 0},    {153, 113, 0, 0}},      // Yellow
+    [4] = {{255, 255, 255, 0},  {0, 0, 255, 0}},        // Mouse layer: White, Blue (swapped)
+    [5] = {{0, 0, 0, 0},        {0, 0, 0, 0}},          // Off
+    [6] = {{138, 43, 226, 0},   {138, 43, 226, 0}},     // Pink, Caps Lock
+};
+
+// Shadow of the trackball LED, only real changes reach the I2C bus
+static uint8_t  led_shadow[4];              // Colour on the trackball
+static uint8_t  led_target[4];              // Colour to write on the next flush
+static bool     led_shadow_valid = false;   // Nothing written yet, first flush always writes
+
+// Writes the latest requested colour, from the deferred executor so the blocking I2C write
+// never runs inside the keyboard, pointing or RPC handlers. Requests made in between collapse into one write.
+static uint32_t led_flush_callback(uint32_t trigger_time, void* cb_arg) {
+    led_token = INVALID_DEFERRED_TOKEN;
+    if (led_shadow_valid && !memcmp(led_shadow, led_target, sizeof(led_shadow))) {
+        return 0;
+    }
+    STAGE_BEGIN(STAGE_LED_WRITE);
+    pimoroni_trackball_set_rgbw(led_target[0], led_target[1], led_target[2], led_target[3]);
+    STAGE_END(STAGE_LED_WRITE);
+    memcpy(led_shadow, led_target, sizeof(led_shadow));
+    led_shadow_valid = true;
+    return 0;
+}
+
 // Set RGBW color of the Pimoroni Trackball based on the active layer.
 // Called by the master device when the layer changes to update itself and the slave devices.
+// Only queues the colour, led_flush_callback() writes it if it differs from what is shown.
 void set_trackball_rgb_for_layer(uint8_t layer) {
-    switch (layer) {
-        case 0:
-            if (BTN_SWAP) { // Provides an indicator that keys are swapped
-                pimoroni_trackball_set_rgbw(255, 255, 255, 0);  // White (base layer, swapped)
-            } else {
-                pimoroni_trackball_set_rgbw(0, 0, 255, 0);      // Blue (base layer, normal)
-            }
-            break;
-        case 1:
-            pimoroni_trackball_set_rgbw(192, 0, 64, 0);         // Red
-            break;
-        case 2:
-            pimoroni_trackball_set_rgbw(0, 192, 128, 0);        // Green
-            break;
-        case 3:
-            pimoroni_trackball_set_rgbw(153, 113, 0, 0);        // Yellow
-            break;
-        case 4:
-            if (BTN_SWAP) {
-                pimoroni_trackball_set_rgbw(0, 0, 255, 0);      // Blue (mouse layer, swapped)
-            } else {
-                pimoroni_trackball_set_rgbw(255, 255, 255, 0);  // White (mouse layer, normal)
-            }
-            break;
-        case 5:
-            pimoroni_trackball_set_rgbw(0, 0, 0, 0);            // Off
-            break;
-        case 6:
-            pimoroni_trackball_set_rgbw(138, 43, 226, 0);       // Pink (Hot Pink)
-            break;
-        default:
-            break;
+    if (layer >= TRACKBALL_COLORS) {
+        return;
+    }
+    memcpy_P(led_target, trackball_colors[layer][BTN_SWAP], sizeof(led_target));
+    if (led_shadow_valid && !memcmp(led_shadow, led_target, sizeof(led_shadow))) {
+        return;     // Already showing, a queued flush will see the same and skip
+    }
+    if (led_token == INVALID_DEFERRED_TOKEN) {
+        led_token = defer_exec(1, led_flush_callback, NULL);
+    }
+}
+
+// Sends the replicated state to the slave, then stays scheduled for one more SYNC_INTERVAL
+// as the rate limit. Changes inside that window go out together when it fires again.
+// Runs from the deferred executor so no RPC lands inside the pointing or keyboard handlers.
+static uint32_t sync_slave_callback(uint32_t trigger_time, void* cb_arg) {
+    if (!SYNC_DIRTY) {
+        sync_token = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
 
-            // Hot Pink (255, 105, 180)
-            // Orange	(255, 165, 0)
-            // Indigo	(75, 0, 130)
-            // Violet	(138, 43, 226)
-            // Purple	(128, 0, 128)
+    // Fields owned by other code are copied in here, their call sites mark the state dirty when they change
+    sync_state.btn_swap = BTN_SWAP;
+    sync_state.atml     = ATML;
+    sync_state.modes    = left_button.mode | (right_button.mode << 4);
+
+    // Keep dirty on failure so the next pass retries with whatever is latest by then
+    STAGE_BEGIN(STAGE_RPC_SYNC);
+    bool sent = transaction_rpc_send(USER_SYNC, sizeof(sync_state), &sync_state);
+    STAGE_END(STAGE_RPC_SYNC);
+    if (sent) {
+        SYNC_DIRTY = false;
+    }
+    trace_event(TRACE_RPC, sync_state.rgb_layer,
+                sync_state.btn_swap | sync_state.atml << 8 | (uint32_t)sync_state.modes << 16 | (uint32_t)sent << 24);
+    return SYNC_INTERVAL;
+}
+
+static void sync_mark_dirty(void) {
+    SYNC_DIRTY = true;
+    if (sync_token == INVALID_DEFERRED_TOKEN) {
+        sync_token = defer_exec(1, sync_slave_callback, NULL);
     }
-    RGB_CURRENT = layer;
 }
 
 // Set RGBW for slave
@@ -796,16 +2092,17 @@ static void set_trackball_rgb_for_slave(uint8_t layer, uint8_t both) {
     // Set number to choose which to update
     // 0 = slave, 1 = master, 2 = both
     if (is_keyboard_master() && (both !=1)) {
-        uint8_t msg[2] = {1, layer};
-        transaction_rpc_send(USER_SYNC, sizeof(msg), msg);
+        // Only marks the replicated state, sync_slave_callback() sends it
+        sync_state.rgb_layer = layer;
+        sync_mark_dirty();
     }
     if (both == 2) {
          set_trackball_rgb_for_layer(layer);
     }
 }
 
-// RPC handler for slave devices to sync RGB based on the active layer.
-// Called when the master sends a layer change RPC event.
+// RPC handler for slave devices to apply the replicated state.
+// Called when the master sends a sync_state_t.
 static void user_sync_slave_handler(
     uint8_t         in_buflen,
     const void*     in_data,
@@ -814,21 +2111,18 @@ static void user_sync_slave_handler(
 
     if (is_keyboard_master()) return;
 
-    if (in_buflen < 2) return;
-    const uint8_t *bytes = (const uint8_t *)in_data;
-    uint8_t type = bytes[0];
-    switch(type) {
-        case 1: // Layer sync
-            set_trackball_rgb_for_layer(bytes[1]);
-            break;
-        case 2: // BTN_SWAP sync
-            BTN_SWAP = (bool)bytes[1];
-            set_trackball_rgb_for_layer(LAYER_CACHE);
-            break;
+    if (in_buflen < sizeof(sync_state_t)) return;
+    memcpy(&sync_state, in_data, sizeof(sync_state_t));
+
+    // BTN_SWAP first, the layer 0 and 4 colours depend on it
+    BTN_SWAP          = sync_state.btn_swap;
+    ATML              = sync_state.atml;
+    left_button.mode  = (emu_mode_t)(sync_state.modes & 0x0F);
+    right_button.mode = (emu_mode_t)(sync_state.modes >> 4);
+    set_trackball_rgb_for_layer(sync_state.rgb_layer);
 
     // Requires #define SPLIT_TRANSACTION_IDS_USER USER_SYNC in config.h
     // Also #include <split_util.h>, #include <transactions.h> in keymap.c
-    }
 }
 
 // Register the RPC handler for USER_RGB_LAYER_SYNC events.
@@ -840,6 +2134,10 @@ void keyboard_post_init_user(void) {
     // pointing_device_set_cpi_on_side(true, 8000);   // Left side: low CPI for scrolling
     // pointing_device_set_cpi_on_side(false, 16000); // Right side: high CPI for standard usage
 
+    stage_clock_init();
+    layer_jump_init();
+    adapt_init();
+    motion_tables_build();
     // Register the RPC handler only on slave side
     if (!is_keyboard_master()) {
         transaction_register_rpc(USER_SYNC, user_sync_slave_handler);
@@ -847,15 +2145,17 @@ void keyboard_post_init_user(void) {
     // Set initial RGB color for base layer
     set_trackball_rgb_for_layer(0);
     // Resets BTN_SWAP for SLAVE on reset, throws off RGB syncing.
+    // Sends the full replicated state, retried every SYNC_INTERVAL until the slave takes it.
     if (is_keyboard_master()) {
-        uint8_t msg[2] = {2, BTN_SWAP};
-        transaction_rpc_send(USER_SYNC, sizeof(msg), msg);
+        sync_mark_dirty();
     }
 }
 
 // Handle layer state changes.
 // Updates the trackball RGB color and sends updated layer info to slave devices.
 layer_state_t layer_state_set_user(layer_state_t state) {
+    STAGE_BEGIN(STAGE_LAYER_STATE);
+    trace_event(TRACE_LAYER, get_highest_layer(state), state);
     if (is_keyboard_master()) {
         LAYER_CACHE = get_highest_layer(state);
         uint8_t sync_layer = LAYER_CACHE;
@@ -868,31 +2168,20 @@ layer_state_t layer_state_set_user(layer_state_t state) {
 
         set_trackball_rgb_for_slave(sync_layer, 2);
     }
+    STAGE_END(STAGE_LAYER_STATE);
     return state;
 }
 
-void housekeeping_task_user(void) {
-    if (is_keyboard_master()) {
-        static uint16_t last_check = 0;
-
-        // Early return if less than 100ms has passed
-        if (timer_elapsed(last_check) < 50) {
-            return;
-        }
-        last_check = timer_read();
-        // Process delayed layer change if timer elapsed
-        if (LJ_PENDING && timer_elapsed(LJ_TIMER) >= LAYER_CHANGE_DELAY) {
-            layer_jump_delay_handler();
-        } else if (LJ_ACTIVE && timer_elapsed(LJ_RELEASE) > 200) {    // Delayed release
-            layer_jump_timeout();
-        }
-        // Turn off caps lock after 30 seconds
-        if (CAPS_ACTIVE && timer_elapsed(CAPS_TIMER) > 30000) {
-            tap_code(KC_CAPS);
-            CAPS_ACTIVE = false;
-        }
+// Turn off caps lock after CAPS_TIMEOUT
+static uint32_t caps_timeout_callback(uint32_t trigger_time, void* cb_arg) {
+    caps_token = INVALID_DEFERRED_TOKEN;
+    if (CAPS_ACTIVE) {
+        tap_code(KC_CAPS);
+        CAPS_ACTIVE = false;
     }
+    return 0;
 }
+
 /*
 void matrix_scan_user(void) {
     if (is_keyboard_master()) {
@@ -920,9 +2209,10 @@ bool led_update_user(led_t led_state) {
             caps_rgb_helper(led_state.caps_lock);
         }
         if (led_state.caps_lock) {
-            CAPS_TIMER = timer_read();
+            deadline_set(&caps_token, CAPS_TIMEOUT, caps_timeout_callback);
             CAPS_ACTIVE = true;
         } else {
+            deadline_cancel(&caps_token);
             CAPS_ACTIVE = false;
         }
     }
@@ -945,16 +2235,94 @@ void caps_word_set_user(bool active) {
 
 // Arrow key simulation constants
 #define ARROW_STEP 8          // Pixel threshold before triggering arrow tap
+#define ARROW_QUEUE_SIZE 8    // Max pending arrow taps (power of 2), extra taps are dropped
+#define ARROW_TAP_INTERVAL 8  // ms between queued arrow taps, sent from the deferred executor
 
 // Arrow key accumulators (scaled by 100 for precision)
 int32_t average_arrow_x = 0;
 int32_t average_arrow_y = 0;
 
+// Time normalized motion
+// Arrow momentum and the scaling average were tuned per report at the trackball's 8ms read interval.
+// They now run on the time since the previous report, so they feel the same at any report rate,
+// whatever POINTING_DEVICE_TASK_THROTTLE_MS, I2C contention or a busy split link do to the interval.
+// The tables are built once at boot, a report only does a lookup and a multiply.
+// Scroll emulation only accumulates distance, it doesn't depend on the interval.
+#define MOTION_REF_MS       8           // Interval the per-report constants were tuned at
+#define MOTION_DT_MAX       64          // Longer gaps count as this, everything has settled by then
+#define KEEP_SHIFT          12          // Retention tables are Q12 (4096 = 1.0)
+#define ARROW_KEEP_PER_MS   1072393738  // Q30, 0.99^(1/8), arrow momentum keeps 0.99 per 8ms
+#define SCALE_KEEP_PER_MS   1065469082  // Q30, 0.94^(1/8), scaling average keeps 0.94 per 8ms
+
+static uint16_t arrow_keep[MOTION_DT_MAX + 1];      // Q12, share of arrow momentum left after dt ms
+static uint16_t scale_keep[MOTION_DT_MAX + 1];      // Q12, share of the scaling average left after dt ms
+static uint16_t motion_rate[MOTION_DT_MAX + 1];     // Q8, MOTION_REF_MS / dt, counts per report -> counts per 8ms
+static uint8_t  motion_dt   = MOTION_REF_MS;        // ms since the previous report, 1 to MOTION_DT_MAX
+static uint16_t motion_last = 0;
+
+static void motion_tables_build(void) {
+    uint32_t arrow = (uint32_t)1 << 30;     // Q30 running powers, rounded to Q12 per entry
+    uint32_t scale = (uint32_t)1 << 30;
+    for (uint8_t dt = 0; dt <= MOTION_DT_MAX; dt++) {
+        arrow_keep[dt]  = (arrow + (1 << 17)) >> 18;
+        scale_keep[dt]  = (scale + (1 << 17)) >> 18;
+        motion_rate[dt] = dt ? ((MOTION_REF_MS << 8) + dt / 2) / dt : 0;
+        arrow = ((uint64_t)arrow * ARROW_KEEP_PER_MS) >> 30;
+        scale = ((uint64_t)scale * SCALE_KEEP_PER_MS) >> 30;
+    }
+}
+
+// Once per report, idle ones included, so the first report after a pause isn't read as slow motion
+static void motion_clock(void) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, motion_last);
+    motion_last = now;
+    motion_dt   = (elapsed < 1) ? 1 : (elapsed > MOTION_DT_MAX) ? MOTION_DT_MAX : elapsed;
+}
+
+// value * keep, truncated toward zero like the old integer divide
+static inline int32_t motion_decay(int32_t value, uint16_t keep) {
+    return (value < 0) ? -((-value * keep) >> KEEP_SHIFT) : ((value * keep) >> KEEP_SHIFT);
+}
+
+// Arrow tap queue, handle_arrow_emulation() only queues taps so the pointing task never blocks on tap_code()
+// Head and tail run freely and wrap on uint8_t, head - tail is the number of pending taps
+static uint8_t  arrow_queue[ARROW_QUEUE_SIZE];
+static uint8_t  arrow_head = 0;
+static uint8_t  arrow_tail = 0;
+
+// Sends one queued arrow tap every ARROW_TAP_INTERVAL until the queue is empty
+static uint32_t arrow_queue_callback(uint32_t trigger_time, void* cb_arg) {
+    if (arrow_head == arrow_tail) {
+        arrow_token = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
+    tap_code(arrow_queue[arrow_tail & (ARROW_QUEUE_SIZE - 1)]);
+    arrow_tail++;
+    return ARROW_TAP_INTERVAL;
+}
+
+static void arrow_queue_push(uint8_t keycode) {
+    // Direction changed, drop the stale taps so the newest direction wins
+    if (arrow_head != arrow_tail && arrow_queue[(uint8_t)(arrow_head - 1) & (ARROW_QUEUE_SIZE - 1)] != keycode) {
+        arrow_tail = arrow_head;
+    }
+    // Queue full, drop the tap instead of letting the delay grow under sustained motion
+    if ((uint8_t)(arrow_head - arrow_tail) >= ARROW_QUEUE_SIZE) {
+        return;
+    }
+    arrow_queue[arrow_head & (ARROW_QUEUE_SIZE - 1)] = keycode;
+    arrow_head++;
+    if (arrow_token == INVALID_DEFERRED_TOKEN) {
+        arrow_token = defer_exec(1, arrow_queue_callback, NULL);
+    }
+}
+
 static void handle_arrow_emulation(report_mouse_t* mouse_report) {
-    // Accumulate with momentum: avg = avg * 0.99 + new_value
-    // (multiply by 100 internally, so 99/100 = 0.99)
-    average_arrow_x = (average_arrow_x * 99) / 100 + mouse_report->x * 100;
-    average_arrow_y = (average_arrow_y * 99) / 100 + mouse_report->y * 100;
+    // Accumulate with momentum: avg = avg * 0.99 per 8ms + new_value
+    // (multiply by 100 internally for precision)
+    average_arrow_x = motion_decay(average_arrow_x, arrow_keep[motion_dt]) + mouse_report->x * 100;
+    average_arrow_y = motion_decay(average_arrow_y, arrow_keep[motion_dt]) + mouse_report->y * 100;
 
     // Lock to dominant axis
     int32_t abs_x = (average_arrow_x < 0) ? -average_arrow_x : average_arrow_x;
@@ -966,15 +2334,15 @@ static void handle_arrow_emulation(report_mouse_t* mouse_report) {
         average_arrow_x = 0;
     }
 
-    // Trigger arrow taps (divide by 100 to convert back to pixels)
+    // Queue arrow taps (divide by 100 to convert back to pixels)
     int32_t threshold = ARROW_STEP * 100;
     while (abs_x >= threshold) {
-        tap_code((average_arrow_x > 0) ? KC_RIGHT : KC_LEFT);
+        arrow_queue_push((average_arrow_x > 0) ? KC_RIGHT : KC_LEFT);
         average_arrow_x += (average_arrow_x > 0) ? -threshold : threshold;
         abs_x = (average_arrow_x < 0) ? -average_arrow_x : average_arrow_x;
     }
     while (abs_y >= threshold) {
-        tap_code((average_arrow_y > 0) ? KC_DOWN : KC_UP);
+        arrow_queue_push((average_arrow_y > 0) ? KC_DOWN : KC_UP);
         average_arrow_y += (average_arrow_y > 0) ? -threshold : threshold;
         abs_y = (average_arrow_y < 0) ? -average_arrow_y : average_arrow_y;
     }
@@ -1032,73 +2400,175 @@ static void handle_scroll_emulation(report_mouse_t* mouse_report) {
 }
 
 // Adaptive Scaling Constants
+// Gains are Q8 fixed point (256 = 1.0x) so applying them is a shift instead of a divide.
+// The RP2040's Cortex-M0+ has no FPU and no divide instruction, every '/' is a library call.
 //#define GROWTH_FACTOR 8 - defined at top for runtime adjustment
-#define MIN_SCALE 1      // Minimum scale (scaled by 1000, so 1 = 0.001)
-#define MAX_SCALE 64000  // Maximum scale (scaled by 1000, so 64000 = 64.0)
+//SCALE_SHIFT, MIN_SCALE and MAX_SCALE - defined at top, the per ball profiles are built from them
+// Average moves 6% of the way to the target per 8ms, SCALE_KEEP_PER_MS above
+// Any target above this saturates the average within 8ms, clamping it first keeps the EMA product in 32 bits
+#define MAX_TARGET      ((int32_t)MAX_SCALE * 16)
+
+// Apply a Q8 gain to one axis, truncating toward zero like the old integer divide
+static inline mouse_xy_report_t apply_scale(mouse_xy_report_t value, int32_t scale) {
+    int32_t scaled = value * scale;
+    return (mouse_xy_report_t)((scaled < 0) ? -((-scaled) >> SCALE_SHIFT) : (scaled >> SCALE_SHIFT));
+}
 
-static void pimoroni_adaptive_scaling(report_mouse_t* mouse_report) {
-    static int32_t accumulated_factor = MIN_SCALE;  // Scaled by 1000
+// Scaling for one ball, with its own profile and average from left_accel / right_accel
+static void pimoroni_adaptive_scaling(report_mouse_t* mouse_report, accel_t* accel) {
 
     // Simple approximate magnitude (Manhattan distance is faster than true length)
     int32_t abs_x = (mouse_report->x < 0) ? -mouse_report->x : mouse_report->x;
     int32_t abs_y = (mouse_report->y < 0) ? -mouse_report->y : mouse_report->y;
     int32_t mouse_length = abs_x + abs_y;
 
-    // Compute factor: GROWTH_FACTOR * mouse_length + MIN_SCALE
-    int32_t factor = GROWTH_FACTOR * mouse_length * 1000 + MIN_SCALE;
+    // Compute factor: GROWTH_FACTOR * speed + MIN_SCALE, speed in counts per 8ms so the rate doesn't change the gain
+    // motion_rate[] is Q8 like the gains, mouse_length * motion_rate[] is already the Q8 speed
+    int32_t factor = accel->growth * mouse_length * motion_rate[motion_dt] + accel->min_scale;
+    if (factor > MAX_TARGET) {
+        factor = MAX_TARGET;
+    }
 
-    // Exponential moving average: accumulated = accumulated * 0.94 + factor * 0.06
-    accumulated_factor = (accumulated_factor * 94 + factor * 6) / 100;
+    // Exponential moving average over time: accumulated = factor + (accumulated - factor) * 0.94 per 8ms
+    accel->factor = factor + motion_decay(accel->factor - factor, scale_keep[motion_dt]);
 
     // Clamp and apply scaling
-    if (accumulated_factor > MAX_SCALE) {
-        accumulated_factor = MAX_SCALE;
+    if (accel->factor > accel->max_scale) {
+        accel->factor = accel->max_scale;
+    }
+
+    mouse_report->x = apply_scale(mouse_report->x, accel->factor);
+    mouse_report->y = apply_scale(mouse_report->y, accel->factor);
+}
+
+// Pointing task effect queue
+// The pointing handlers only record what should happen to the LEDs and layers. housekeeping_task_user()
+// applies it after the mouse report has gone out, so RPC marking, LED and layer_state_set_user() work
+// never sits between reading the trackballs and sending the report.
+typedef enum effect_ops {
+    EFFECT_RGB,         // a = colour layer, b = target as in set_trackball_rgb_for_slave(), 1 = master only
+    EFFECT_LAYER_ON,    // a = layer
+    EFFECT_LAYER_OFF    // a = layer
+} effect_op_t;
+
+typedef struct effect {
+    uint8_t         op;         // effect_op_t
+    uint8_t         a;
+    uint8_t         b;
+} effect_t;
+
+#define EFFECT_QUEUE_SIZE 8     // Power of 2, a report queues at most 4
+
+static effect_t effect_queue[EFFECT_QUEUE_SIZE];
+static uint8_t  effect_head = 0;    // Free running, masked on access
+static uint8_t  effect_tail = 0;
+
+// Layer effects only build up the masks, the caller applies them once with layer_apply()
+static void effect_apply(effect_t effect, layer_state_t* on_mask, layer_state_t* off_mask) {
+    switch (effect.op) {
+        case EFFECT_RGB:
+            if (effect.b == 1) {
+                set_trackball_rgb_for_layer(effect.a);
+            } else {
+                set_trackball_rgb_for_slave(effect.a, effect.b);
+            }
+            break;
+        case EFFECT_LAYER_ON:
+            *on_mask  |=  LAYER_BIT(effect.a);
+            *off_mask &= ~LAYER_BIT(effect.a);
+            break;
+        case EFFECT_LAYER_OFF:
+            *off_mask |=  LAYER_BIT(effect.a);
+            *on_mask  &= ~LAYER_BIT(effect.a);
+            break;
+    }
+}
+
+static void effect_push(uint8_t op, uint8_t a, uint8_t b) {
+    effect_t effect = {op, a, b};
+    if ((uint8_t)(effect_head - effect_tail) >= EFFECT_QUEUE_SIZE) {
+        // Full, apply now rather than lose a layer change
+        layer_state_t on_mask = 0, off_mask = 0;
+        effect_apply(effect, &on_mask, &off_mask);
+        layer_apply(on_mask, off_mask);
+        return;
     }
+    effect_queue[effect_head++ & (EFFECT_QUEUE_SIZE - 1)] = effect;
+}
 
-    mouse_report->x = (int16_t)((mouse_report->x * accumulated_factor) / 1000);
-    mouse_report->y = (int16_t)((mouse_report->y * accumulated_factor) / 1000);
+// Runs once per main loop, after keyboard_task() has sent the mouse report
+void housekeeping_task_user(void) {
+    if (effect_tail == effect_head) {
+        return;
+    }
+    layer_state_t on_mask = 0, off_mask = 0;
+    while (effect_tail != effect_head) {
+        effect_apply(effect_queue[effect_tail++ & (EFFECT_QUEUE_SIZE - 1)], &on_mask, &off_mask);
+    }
+    layer_apply(on_mask, off_mask);     // Last, as the layer effects always came after the LED ones
 }
 
-// Handles emulation state of trackballs
-static btn_state_t handle_mouse_buttons(report_mouse_t report, btn_state_t state) {
+// Handles emulation state of trackballs, updates state in place
+static void handle_mouse_buttons(const report_mouse_t* report, btn_state_t* state) {
     // Bitwise operation shifts 1 to the left 0 times, then checks if bitfield of report is 0 after the bitmask
-    bool pressed = (report.buttons & (1 << 0)) != 0;
+    bool pressed = (report->buttons & (1 << 0)) != 0;
     uint16_t now = timer_read(); //
-
-    if (pressed && !state.button_was_pressed) {
-        if (state.mode == MODE_OFF) {
-            state.mode = MODE_PENDING;
-            state.last_press_time = now;
-            set_trackball_rgb_for_slave(0, 2);
-        } else if (state.mode == MODE_PENDING) {
-            if (timer_elapsed(state.last_press_time) < 400) {
-                state.mode = MODE_ARROW;
-                set_trackball_rgb_for_slave(1, 2);
+    emu_mode_t mode = state->mode;
+
+    if (pressed && !state->button_was_pressed) {
+        if (state->mode == MODE_OFF) {
+            state->mode = MODE_PENDING;
+            state->last_press_time = now;
+            effect_push(EFFECT_RGB, 0, 2);
+        } else if (state->mode == MODE_PENDING) {
+            if (timer_elapsed(state->last_press_time) < 400) {
+                state->mode = MODE_ARROW;
+                effect_push(EFFECT_RGB, 1, 2);
             } else {
-                state.last_press_time = now;
+                state->last_press_time = now;
             }
         } else {
             // MODE_ARROW or MODE_SCROLL active → turn off
-            state.mode = MODE_OFF;
-            set_trackball_rgb_for_slave(0, 2);
+            state->mode = MODE_OFF;
+            effect_push(EFFECT_RGB, 0, 2);
         }
-    } else if (state.mode == MODE_PENDING) {
-        if (timer_elapsed(state.last_press_time) >= 400) {
-            state.mode = MODE_SCROLL;
-            set_trackball_rgb_for_slave(2, 2);
+    } else if (state->mode == MODE_PENDING) {
+        if (timer_elapsed(state->last_press_time) >= 400) {
+            state->mode = MODE_SCROLL;
+            effect_push(EFFECT_RGB, 2, 2);
         }
     }
 
-    // Always update the button pressed flag before returning
-    state.button_was_pressed = pressed;
-    return state;
+    // Modes are part of the replicated state
+    if (state->mode != mode) {
+        sync_mark_dirty();
+    }
+
+    // Always update the button pressed flag
+    state->button_was_pressed = pressed;
+}
+
+// Idle timeout → revert to current layer
+static uint32_t rgb_ms_timeout_callback(uint32_t trigger_time, void* cb_arg) {
+    uint32_t remaining = deadline_remaining(RGB_MS_TIMER, RGB_MS_TIMEOUT);
+    if (RGB_MS_ACTIVE && remaining) {
+        return remaining;
+    }
+    rgb_ms_token = INVALID_DEFERRED_TOKEN;
+    if (RGB_MS_ACTIVE) {
+        RGB_MS_ACTIVE = false;
+        led_t caps = host_keyboard_led_state();
+        uint8_t current_layer = caps.caps_lock ? 6 : LAYER_CACHE;
+        set_trackball_rgb_for_slave(current_layer, 2);
+    }
+    return 0;
 }
 
 // Mouse Mode Handling Syncing RGB & Swaping layer 0 keys to mouse keys for mousing
-static report_mouse_t handle_mouse_mode_rgb(report_mouse_t left_report, report_mouse_t right_report) {
+static void handle_mouse_mode_rgb(const report_mouse_t* left_report, const report_mouse_t* right_report) {
     // Combine movement
-    int16_t combined_x = left_report.x + right_report.x;
-    int16_t combined_y = left_report.y + right_report.y;
+    int16_t combined_x = left_report->x + right_report->x;
+    int16_t combined_y = left_report->y + right_report->y;
 
     // Map button modes to layers (4=off, 1=arrow, 2=scroll)
     static const uint8_t mode_to_layer[] = {
@@ -1124,82 +2594,125 @@ static report_mouse_t handle_mouse_mode_rgb(report_mouse_t left_report, report_m
     if (combined_x || combined_y) {
         // Only update on first activation
         if (!RGB_MS_ACTIVE) {
-//            if (RGB_CURRENT == 0) {
-                set_trackball_rgb_for_layer(m_m_layer);
-                set_trackball_rgb_for_slave(m_s_layer, 0);
-//            }
+            effect_push(EFFECT_RGB, m_m_layer, 1);
+            effect_push(EFFECT_RGB, m_s_layer, 0);
             RGB_MS_ACTIVE = true;
         }
-        // Throttle timer updates
-        if (timer_elapsed(RGB_MS_TIMER) > TIMER_LIMITER) {
-            RGB_MS_TIMER = timer_read();
+        // Idle timeout is handled by rgb_ms_timeout_callback()
+        RGB_MS_TIMER = timer_read();
+        if (rgb_ms_token == INVALID_DEFERRED_TOKEN) {
+            rgb_ms_token = defer_exec(RGB_MS_TIMEOUT, rgb_ms_timeout_callback, NULL);
         }
-
-    // Idle timeout → revert to current layer
-    } else if (RGB_MS_ACTIVE && timer_elapsed(RGB_MS_TIMER) > RGB_MS_TIMEOUT) {
-        RGB_MS_ACTIVE = false;
-        led_t caps = host_keyboard_led_state();
-        uint8_t current_layer = caps.caps_lock ? 6 : LAYER_CACHE;
-        set_trackball_rgb_for_slave(current_layer, 2);
-
     }
+}
 
-    return pointing_device_combine_reports(left_report, right_report);
+// Auto Mouse Layer timeout, keys and movement push it back through ATML_TIMER
+static uint32_t atml_timeout_callback(uint32_t trigger_time, void* cb_arg) {
+    uint32_t remaining = deadline_remaining(ATML_TIMER, ATML_TIMEOUT);
+    if (ATML_ACTIVE && remaining) {
+        return remaining;
+    }
+    atml_token = INVALID_DEFERRED_TOKEN;
+    if (ATML_ACTIVE) {
+        layer_off(3);
+        ATML_ACTIVE = false;
+    }
+    return 0;
 }
 
 // Custom Auto Mouse Layer
 static void auto_mouse_layer_handler(report_mouse_t* mouse_report) {
-    uint16_t elapsed = timer_elapsed(ATML_TIMER);
-
     if (mouse_report->x || mouse_report->y) {
         if (!ATML_ACTIVE) {
-            layer_on(3);
+            effect_push(EFFECT_LAYER_ON, 3, 0);
             ATML_ACTIVE = true;
             RGB_MS_ACTIVE = false; // REMOVE??
         }
-        if (elapsed > TIMER_LIMITER) {
-            ATML_TIMER = timer_read();
+        ATML_TIMER = timer_read();
+        if (atml_token == INVALID_DEFERRED_TOKEN) {
+            atml_token = defer_exec(ATML_TIMEOUT, atml_timeout_callback, NULL);
         }
-    } else if (ATML_ACTIVE && elapsed > ATML_TIMEOUT) {
-        layer_off(3);
-        ATML_ACTIVE = false;
     }
 }
 
-report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, report_mouse_t right_report) {
-    if (is_keyboard_master()) {
-        // Handle button logic
-        left_button  = handle_mouse_buttons(left_report, left_button);
-        right_button = handle_mouse_buttons(right_report, right_button);
-
-        // Handle Mousing Mode or Auto Mouse Layer
-        if (ATML) {
-            auto_mouse_layer_handler(&left_report);
-            auto_mouse_layer_handler(&right_report);
-        } else {
-            handle_mouse_mode_rgb(left_report, right_report);
-        }
+// Nothing to do for a report with no movement and no button change, once every time based
+// state has settled: no double tap pending, arrow momentum and scaling average decayed to rest
+static inline bool pointing_idle(const report_mouse_t* report, const btn_state_t* state) {
+    return !report->x && !report->y
+        && ((report->buttons & (1 << 0)) != 0) == state->button_was_pressed
+        && state->mode != MODE_PENDING;
+}
+
+// Emulation for one ball, its button mode takes precedence over layers 1/2 so a ball runs at most one kernel
+// Returns true if the ball ran arrow emulation
+static bool pointing_emulate(report_mouse_t* report, emu_mode_t mode) {
+    if (mode != MODE_ARROW && mode != MODE_SCROLL && (LAYER_CACHE == 1 || LAYER_CACHE == 2)) {
+        mode = (emu_mode_t)LAYER_CACHE;     // Layer 1 = MODE_ARROW, layer 2 = MODE_SCROLL
+    }
+    if (mode == MODE_ARROW) {
+        handle_arrow_emulation(report);
+    } else if (mode == MODE_SCROLL) {
+        handle_scroll_emulation(report);
+    }
+    return mode == MODE_ARROW;
+}
 
-        // Helper lambda-like (inline) function for repeated emulations
-        void (*emulate[])(report_mouse_t*) = {NULL, handle_arrow_emulation, handle_scroll_emulation};
+// Pointing pipeline, works in place on both reports and leaves combining to the caller
+static void pointing_pipeline(report_mouse_t* left_report, report_mouse_t* right_report) {
+    motion_clock();
+    if (pointing_idle(left_report, &left_button) && pointing_idle(right_report, &right_button)
+        && left_accel.factor == left_accel.min_scale && right_accel.factor == right_accel.min_scale
+        && !average_arrow_x && !average_arrow_y) {
+        return;
+    }
 
-        // Apply continuous emulation depending on active mode (left and right)
-        if (left_button.mode == MODE_ARROW || left_button.mode == MODE_SCROLL) {
-            emulate[left_button.mode](&left_report);
-        }
-        if (right_button.mode == MODE_ARROW || right_button.mode == MODE_SCROLL) {
-            emulate[right_button.mode](&right_report);
-        }
+    trace_mouse(TRACE_MOUSE_L, left_report);
+    trace_mouse(TRACE_MOUSE_R, right_report);
+    adapt_pointer(left_report, right_report);
+
+    // Handle button logic
+    STAGE_BEGIN(STAGE_BUTTONS);
+    uint8_t modes = left_button.mode | (right_button.mode << 4);
+    handle_mouse_buttons(left_report, &left_button);
+    handle_mouse_buttons(right_report, &right_button);
+    STAGE_END(STAGE_BUTTONS);
+    if (modes != (left_button.mode | (right_button.mode << 4))) {
+        trace_event(TRACE_MODE, left_button.mode | (right_button.mode << 4), 0);
+    }
 
-        if (LAYER_CACHE == 1 || LAYER_CACHE == 2) {
-            // Incrementing to offset and match emu_mode_t struct index
-            emulate[LAYER_CACHE](&left_report);
-            emulate[LAYER_CACHE](&right_report);
-        }
+    // Handle Mousing Mode or Auto Mouse Layer
+    STAGE_BEGIN(STAGE_MOUSE_MODE);
+    if (ATML) {
+        auto_mouse_layer_handler(left_report);
+        auto_mouse_layer_handler(right_report);
+    } else {
+        handle_mouse_mode_rgb(left_report, right_report);
+    }
+    STAGE_END(STAGE_MOUSE_MODE);
+
+    // Apply continuous emulation depending on active mode (left and right)
+    STAGE_BEGIN(STAGE_EMULATION);
+    bool arrow = pointing_emulate(left_report, left_button.mode);
+    arrow |= pointing_emulate(right_report, right_button.mode);
+    if (!arrow) {
+        // Left arrow mode, momentum only decays in handle_arrow_emulation() and would keep the idle exit off
+        average_arrow_x = 0;
+        average_arrow_y = 0;
+    }
+    STAGE_END(STAGE_EMULATION);
+
+    // Adaptive scaling
+    STAGE_BEGIN(STAGE_SCALING);
+    pimoroni_adaptive_scaling(left_report, &left_accel);
+    pimoroni_adaptive_scaling(right_report, &right_accel);
+    STAGE_END(STAGE_SCALING);
+}
 
-        // Adaptive scaling
-        pimoroni_adaptive_scaling(&left_report);
-        pimoroni_adaptive_scaling(&right_report);
+report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, report_mouse_t right_report) {
+    STAGE_BEGIN(STAGE_POINTING);
+    if (is_keyboard_master()) {
+        stage_count_report();
+        pointing_pipeline(&left_report, &right_report);
 
         // Clear buttons before sending
         // Repurposed to redirect mouse inputs
@@ -1207,7 +2720,12 @@ report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, re
         right_report.buttons = 0;
     }
 
-    return pointing_device_combine_reports(left_report, right_report);
+    // Combined exactly once
+    STAGE_BEGIN(STAGE_COMBINE);
+    report_mouse_t combined = pointing_device_combine_reports(left_report, right_report);
+    STAGE_END(STAGE_COMBINE);
+    STAGE_END(STAGE_POINTING);
+    return combined;
 }
 
 /*
@@ -1226,6 +2744,44 @@ report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, re
 QK_COMBO_ON	    CM_ON	Turns on Combo feature
 QK_COMBO_OFF	CM_OFF	Turns off Combo feature
 
+10.17.2026
+-Moved pimoroni_adaptive_scaling() to Q8 fixed point, no divisions per report. Same curve within 1 count.
+-Arrow emulation queues its taps, housekeeping_task_user() sends them at a fixed rate. Fast trackball motion no longer stalls the mouse report.
+-Replaced per-call 2-byte RPCs with one replicated state block (layer colour, BTN_SWAP, ATML, modes) sent from housekeeping when dirty, at most every 10ms.
+-Moved layer jump, caps lock, auto mouse layer, mouse mode RGB, arrow queue and slave sync timers to defer_exec() deadlines. Removed housekeeping_task_user() polling and TIMER_LIMITER, timeouts fire within ~1ms.
+-Dual-function keys now come from a PROGMEM table indexed by keycode - SAFE_RANGE instead of 27 switch cases.
+-Timed keys keep their press time in a small pool keyed by matrix position instead of the shared rd1/ld1/ri1/le1 timers. Fast rolls no longer overwrite each other.
+-Timed tap-hold keys fire their hold action when the tapping term passes instead of on release. UN_RE, VU_VD and PU_PD hold their action down so it repeats.
+-SE_PW plays from an asynchronous macro player instead of send_string() + wait_ms(200). Scanning, split transport and trackballs keep running during the macro.
+-Macro text goes out through send_batch(), runs of increasing keycodes share one NKRO report. ' 2326' takes 6 reports instead of 10.
+-Combos are indexed for the active layers, rebuilt on the first combo key after a layer, default layer (DF) or VIA keymap change. combo_should_trigger() stops keys from being buffered for combos that can't fire on the active layers.
+-Combos are generated from one COMBO_LIST, any number of keys per combo. A key -> combos index built from key_combos[] at boot serves combo_should_trigger() and the skew learner. QMK's combo engine still matches against key_combos[] itself.
+-debug_mouse_reports() and its uprintf lines are replaced by a binary event trace. Records go into a ring and are drained to the console in the background, Tools/trace_decode.py turns them into a timeline.
+-Optional keypress latency histograms (LATENCY_STATS, off by default) per category (home row mods, layer jump, tap-hold, other), read over a VIA custom channel with Tools/latency_report.py.
+-Optional per-stage cycle counters (STAGE_PROFILE) for the pointing pipeline, layer_state_set_user(), the RPC sync and trackball LED writes, read over VIA with Tools/stage_report.py.
+-Pointing pipeline works in place on both reports, skips idle reports and combines once. A ball runs at most one emulation kernel per report.
+-Trackball colours come from a PROGMEM table. LED writes go through a shadow register and a deferred flush, so unchanged colours never reach I2C.
+-Pointing handlers queue their LED and layer changes in a small effect queue, housekeeping_task_user() applies them after the mouse report is sent.
+-Added layer_apply(on_mask, off_mask) for batched layer changes. Layer jump release, delayed activation and queued pointing layer effects each apply one layer state.
+-Layer jump keys keep per-key state with an exact deadline and work with any layer. Another key pressed after LAYER_EARLY_MIN commits the layer early. Removed LJ_LAYER and LJ_PENDING.
+-Home row mods use speculative hold (Ctrl/Shift on press, retracted on tap) and per-key permissive hold. Tools/hrm_sim.py replays traced typing to count misfires and latency saved.
+-Tapping terms adapt per key. Mod-taps and layer-taps keep tap and hold timing histograms, the term moves to the valley between them and is saved to EEPROM every 10 minutes (TAPPING_TERM_ADAPT).
+-Layer jump early commit and tapping term adaptation see every key press from pre_process_record_user(), which QMK runs before the combo buffer holds keys back.
+-Each combo learns its own term from the press skew of its chords, p99 plus 3ms between 6ms and COMBO_TERM. Replaced the placeholder get_combo_term().
+-Adaptive scaling and arrow momentum run on the measured time between reports, speed is normalized to counts per 8ms. Same feel at any report rate.
+-Each trackball has its own acceleration profile (growth, min and max gain) and its own scaling average. FX_SLV_M/FX_SLV_P adjust the left ball with Left Shift held, the right ball with Right Shift held, otherwise both.
+-BTN_SWAP, ATML and trackball mode changes now mark the split sync dirty themselves instead of riding along on an RGB update.
+-send_batch() takes the shift state from the first typeable character, a leading character with no keycode no longer drops the shift of the one after it.
+-Layer jump keys free their press record on release even if B_SWAP flipped while they were held. A swap used to leak the slot and keep layer_jump_held() true. B_SWAP also cancels jump keys that are still pending.
+-Learned tapping terms can climb again. A lone press released before the default term is sampled as a slow tap, and permissive hold keys sample holds at release instead of at the first other key.
+-Per ball acceleration is set with LEFT_/RIGHT_GROWTH_FACTOR, _MIN_SCALE and _MAX_SCALE in config.h. SCALE_SHIFT, MIN_SCALE and MAX_SCALE moved to the top next to GROWTH_FACTOR, a per ball max above MAX_SCALE fails the build.
+-Removed RGB_CURRENT, it was written on every LED request and never read. led_shadow/led_target already skip repeated colours.
+-Leaving arrow mode clears the arrow momentum, so idle trackball reports take the early exit again.
+-Tapping term learner: a trackball click while an adapted key is held marks where the hold was wanted, a lone press while the ball moved is not sampled. A save that found no free deferred executor is retried on the next sample.
+-Layer 4 has Right Shift on the outer right home row key, so FX_SLV_M/FX_SLV_P can select the right ball. Before, every right half key there was KC_NO and the right ball could never be adjusted on its own.
+-Combo skew is only sampled once the combo fires (its COMBO_EVENT), rolls inside COMBO_TERM that come out as normal keys no longer widen the learned term
+-Combos are matched in keymap.c from compile-time position tables generated by COMBO_LIST, QMK's combo engine is off, each key event only checks the combos that contain it on the current layer
+
 9.16.2025
 -Added some runtime checks in master to slave syncing functions to prevent potential loops in communication.
 
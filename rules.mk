@@ -18,7 +18,8 @@ VIA_ENABLE          = yes     # Enable VIA
 LTO_ENABLE          = yes
 NKRO_ENABLE 		= yes
 
-COMBO_ENABLE		= yes
+COMBO_ENABLE		= no      # Combos are matched in keymap.c, see COMBO_LIST
+DEFERRED_EXEC_ENABLE= yes     # Timeouts and paced output in keymap.c
 FORCE_NKRO			= yes
 SEND_STRING_ENABLE	= yes
 